@@ -1,12 +1,22 @@
 #include "ArchiveAccess.h"
+#include "ArchivePool.h"
+#include "BethesdaArchive.h"
 
+#include <QDebug>
 #include <QDir>
+#include <QHash>
 #include <QStringList>
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <filesystem>
 #include <utility>
+#include <vector>
 
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
 #include <libbsarch/bs_archive.h>
+#endif
 
 namespace {
 QString normalizeDataPath(QString path) {
@@ -45,10 +55,159 @@ void setResult(
         result->size = size;
     }
 }
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+constexpr auto DefaultBackend = ArchiveAccess::Backend::Libbsarch;
+#else
+constexpr auto DefaultBackend = ArchiveAccess::Backend::Native;
+#endif
+
+std::atomic<ArchiveAccess::Backend> activeBackend {DefaultBackend};
+
+ArchiveAccess::ExtractedBytes readNative(
+    const std::shared_ptr<PooledArchive>& pooled,
+    const BethesdaArchive& archive,
+    const BethesdaArchiveEntry& entry,
+    const QString& path,
+    ArchiveAccess::ExtractResult* result
+) {
+    using ArchiveAccess::ExtractStatus;
+
+    if (const auto mapped = archive.mappedBytes(entry); !mapped.empty()) {
+        setResult(result, ExtractStatus::Found, path, {}, entry.size);
+        return {pooled, mapped};
+    }
+
+    QByteArray bytes(static_cast<qsizetype>(entry.size), Qt::Uninitialized);
+    QString error;
+    if (!archive.read(entry, {bytes.data(), static_cast<std::size_t>(bytes.size())}, &error)) {
+        setResult(result, ExtractStatus::Error, path, error);
+        return {};
+    }
+
+    setResult(result, ExtractStatus::Found, path, {}, entry.size);
+    return ArchiveAccess::ExtractedBytes(std::move(bytes));
+}
+
+ArchiveAccess::ExtractedBytes extractNative(
+    const std::shared_ptr<PooledArchive>& pooled,
+    const BethesdaArchive& archive,
+    const QString& dataPath,
+    const int maxSize,
+    ArchiveAccess::ExtractResult* result
+) {
+    using ArchiveAccess::ExtractStatus;
+
+    const auto path = normalizeDataPath(dataPath);
+    const auto entry = archive.find(path);
+    if (!entry || entry->size == 0) {
+        setResult(result, ExtractStatus::Missing);
+        return {};
+    }
+
+    if (std::cmp_greater(entry->size, maxSize)) {
+        setResult(result, ExtractStatus::Oversized, path, {}, entry->size);
+        return {};
+    }
+
+    return readNative(pooled, archive, *entry, path, result);
+}
+
+void extractNativeBatch(
+    const std::shared_ptr<PooledArchive>& pooled,
+    const BethesdaArchive& archive,
+    const QVector<ArchiveAccess::BatchRead>& reads,
+    const QVector<qsizetype>& readIndices,
+    const int maxSize,
+    QVector<ArchiveAccess::ExtractedBytes>& results
+) {
+    struct PendingRead {
+        qsizetype index = 0;
+        QString path;
+        BethesdaArchiveEntry entry;
+    };
+
+    std::vector<PendingRead> pending;
+    pending.reserve(static_cast<std::size_t>(readIndices.size()));
+    for (const auto index : readIndices) {
+        auto path = normalizeDataPath(reads[index].dataPath);
+        const auto entry = archive.find(path);
+        if (entry && entry->size != 0 && !std::cmp_greater(entry->size, maxSize)) {
+            pending.push_back({.index = index, .path = std::move(path), .entry = *entry});
+        }
+    }
+
+    std::ranges::sort(pending, {}, [](const PendingRead& read) {
+        return read.entry.offset;
+    });
+    for (const auto& read : pending) {
+        ArchiveAccess::ExtractResult result;
+        results[read.index] = readNative(pooled, archive, read.entry, read.path, &result);
+        if (result.status == ArchiveAccess::ExtractStatus::Error) {
+            qWarning("Failed to read '%s' from archive: %s", qUtf8Printable(read.path), qUtf8Printable(result.error));
+        }
+    }
+}
+
+QVector<ArchiveAccess::FileInfo> listNativeFiles(const BethesdaArchive& archive, QString* error) {
+    QString listError;
+    const auto entries = archive.files(&listError);
+    if (!listError.isEmpty()) {
+        if (error) {
+            *error = listError;
+        }
+        return {};
+    }
+
+    QVector<ArchiveAccess::FileInfo> files;
+    files.reserve(static_cast<qsizetype>(entries.size()));
+    for (const auto& file : entries) {
+        // BSA listings only point at the raw record; resolve sizes through find().
+        auto entry = file.entry;
+        if (entry.size == 0) {
+            if (const auto resolved = archive.find(file.path)) {
+                entry = *resolved;
+            }
+        }
+        files.append({file.path, entry.offset, entry.size, entry.packedSize, entry.compressed});
+    }
+    if (error) {
+        error->clear();
+    }
+    return files;
+}
 } // namespace
 
 namespace ArchiveAccess {
 
+ExtractedBytes::ExtractedBytes(QByteArray buffer)
+    : m_Buffer(std::move(buffer))
+    , m_Bytes(m_Buffer.constData(), static_cast<std::size_t>(m_Buffer.size())) {}
+
+ExtractedBytes::ExtractedBytes(std::shared_ptr<const void> owner, const std::span<const char> bytes)
+    : m_Owner(std::move(owner))
+    , m_Bytes(bytes) {}
+
+QByteArray ExtractedBytes::toByteArray() const {
+    if (m_Owner) {
+        return {m_Bytes.data(), static_cast<qsizetype>(m_Bytes.size())};
+    }
+    return m_Buffer;
+}
+
+void setBackend(Backend backend) {
+#ifndef PREVIEW_NIF_WITH_LIBBSARCH
+    backend = Backend::Native;
+#endif
+    if (activeBackend.exchange(backend) != backend) {
+        ArchivePool::instance().clear();
+    }
+}
+
+Backend backend() {
+    return activeBackend.load();
+}
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
 bool loadArchive(libbsarch::bs_archive& archive, const QString& archivePath, QString* error) {
     try {
         archive.load_from_disk(QDir::toNativeSeparators(archivePath).toStdWString());
@@ -124,5 +283,156 @@ QByteArray extractBytes(
     setResult(result, ExtractStatus::Missing);
     return {};
 }
+#endif
+
+bool containsDataPath(const QString& archivePath, const QString& dataPath, QString* errorPath, QString* error) {
+    QString loadError;
+    const auto pooled = ArchivePool::instance().acquire(archivePath, &loadError);
+    if (!pooled) {
+        if (errorPath) {
+            *errorPath = archivePath;
+        }
+        if (error) {
+            *error = loadError;
+        }
+        return false;
+    }
+
+    if (const auto* archive = pooled->nativeArchive()) {
+        if (errorPath) {
+            errorPath->clear();
+        }
+        if (error) {
+            error->clear();
+        }
+        return archive->find(normalizeDataPath(dataPath)).has_value();
+    }
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    const auto lock = pooled->lock();
+    return containsDataPath(*pooled->libbsarchArchive(), dataPath, errorPath, error);
+#else
+    return false;
+#endif
+}
+
+QByteArray extractBytes(
+    const QString& archivePath,
+    const QString& dataPath,
+    const int maxSize,
+    ExtractResult* result
+) {
+    return extractView(archivePath, dataPath, maxSize, result).toByteArray();
+}
+
+ExtractedBytes extractView(
+    const QString& archivePath,
+    const QString& dataPath,
+    const int maxSize,
+    ExtractResult* result
+) {
+    QString loadError;
+    const auto pooled = ArchivePool::instance().acquire(archivePath, &loadError);
+    if (!pooled) {
+        setResult(result, ExtractStatus::Error, archivePath, loadError);
+        return {};
+    }
+
+    if (const auto* archive = pooled->nativeArchive()) {
+        return extractNative(pooled, *archive, dataPath, maxSize, result);
+    }
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    // libbsarch reuses its extraction buffer, so its bytes are copied once while locked.
+    const auto lock = pooled->lock();
+    return ExtractedBytes(extractBytes(*pooled->libbsarchArchive(), dataPath, maxSize, result));
+#else
+    setResult(result, ExtractStatus::Missing);
+    return {};
+#endif
+}
+
+QVector<ExtractedBytes> extractBatch(const QVector<BatchRead>& reads, const int maxSize) {
+    QVector<ExtractedBytes> results(reads.size());
+    QHash<QString, QVector<qsizetype>> archiveReads;
+    QStringList archiveOrder;
+    for (qsizetype i = 0; i < reads.size(); ++i) {
+        const auto key = QDir::fromNativeSeparators(reads[i].archivePath).toLower();
+        auto& indices = archiveReads[key];
+        if (indices.isEmpty()) {
+            archiveOrder.append(key);
+        }
+        indices.append(i);
+    }
+
+    for (const auto& key : archiveOrder) {
+        const auto& indices = archiveReads[key];
+        const auto pooled = ArchivePool::instance().acquire(reads[indices.constFirst()].archivePath);
+        if (!pooled) {
+            continue;
+        }
+
+        if (const auto* archive = pooled->nativeArchive()) {
+            extractNativeBatch(pooled, *archive, reads, indices, maxSize, results);
+            continue;
+        }
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+        // libbsarch does not expose record offsets, so its reads keep request order.
+        const auto lock = pooled->lock();
+        for (const auto index : indices) {
+            results[index] = ExtractedBytes(extractBytes(*pooled->libbsarchArchive(), reads[index].dataPath, maxSize));
+        }
+#endif
+    }
+
+    return results;
+}
+
+QVector<FileInfo> listFiles(const QString& archivePath, QString* error) {
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    // libbsarch lists names only. The native parser reads just the tables, so it fills in
+    // record sizes for the index whichever backend extracts the data.
+    if (backend() == Backend::Libbsarch) {
+        if (const auto archive = BethesdaArchive::open(archivePath)) {
+            return listNativeFiles(*archive, error);
+        }
+    }
+#endif
+
+    QString loadError;
+    const auto pooled = ArchivePool::instance().acquire(archivePath, &loadError);
+    if (!pooled) {
+        if (error) {
+            *error = loadError;
+        }
+        return {};
+    }
+
+    if (const auto* archive = pooled->nativeArchive()) {
+        return listNativeFiles(*archive, error);
+    }
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    QVector<FileInfo> files;
+    const auto lock = pooled->lock();
+    try {
+        for (const auto& file : pooled->libbsarchArchive()->list_files()) {
+            files.append({QString::fromStdWString(std::filesystem::path(file).wstring())});
+        }
+        if (error) {
+            error->clear();
+        }
+        return files;
+    } catch (const std::exception& exception) {
+        if (error) {
+            *error = QString::fromLocal8Bit(exception.what());
+        }
+        return {};
+    }
+#else
+    return {};
+#endif
+}
 
 }
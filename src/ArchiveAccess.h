@@ -2,16 +2,29 @@
 
 #include <QByteArray>
 #include <QString>
+#include <QVector>
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <span>
 
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
 namespace libbsarch {
 class bs_archive;
 }
+#endif
 
 namespace ArchiveAccess {
 
+// Native is the in-tree memory-mapped reader; Libbsarch is only available when the
+// plugin is built with PREVIEW_NIF_WITH_LIBBSARCH.
+enum class Backend {
+    Native,
+    Libbsarch
+};
+
 enum class ExtractStatus {
     Missing,
     Found,
@@ -26,6 +39,53 @@ struct ExtractResult {
     std::uint32_t size = 0;
 };
 
+struct BatchRead {
+    QString archivePath;
+    QString dataPath;
+};
+
+// Offsets and sizes come from the native parser and are zero only for archives it cannot read.
+struct FileInfo {
+    QString path;
+    std::uint64_t offset = 0;
+    std::uint32_t size = 0;
+    std::uint32_t packedSize = 0;
+    bool compressed = false;
+};
+
+// Extracted record bytes. Uncompressed records read by the native backend point into the
+// archive mapping and keep the pooled archive alive; everything else owns a buffer.
+class ExtractedBytes {
+public:
+    ExtractedBytes() = default;
+    explicit ExtractedBytes(QByteArray buffer);
+    ExtractedBytes(std::shared_ptr<const void> owner, std::span<const char> bytes);
+
+    [[nodiscard]] bool isEmpty() const noexcept {
+        return m_Bytes.empty();
+    }
+    [[nodiscard]] const char* data() const noexcept {
+        return m_Bytes.data();
+    }
+    [[nodiscard]] std::size_t size() const noexcept {
+        return m_Bytes.size();
+    }
+    [[nodiscard]] std::span<const char> bytes() const noexcept {
+        return m_Bytes;
+    }
+    // Shares an owned buffer; copies bytes that point into an archive mapping.
+    [[nodiscard]] QByteArray toByteArray() const;
+
+private:
+    QByteArray m_Buffer;
+    std::shared_ptr<const void> m_Owner;
+    std::span<const char> m_Bytes;
+};
+
+void setBackend(Backend backend);
+[[nodiscard]] Backend backend();
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
 bool loadArchive(libbsarch::bs_archive& archive, const QString& archivePath, QString* error = nullptr);
 bool containsDataPath(
     libbsarch::bs_archive& archive,
@@ -39,5 +99,33 @@ QByteArray extractBytes(
     int maxSize = std::numeric_limits<int>::max(),
     ExtractResult* result = nullptr
 );
+#endif
+
+// Path-based lookups share loaded archives through ArchivePool instead of reopening them.
+bool containsDataPath(
+    const QString& archivePath,
+    const QString& dataPath,
+    QString* errorPath = nullptr,
+    QString* error = nullptr
+);
+QByteArray extractBytes(
+    const QString& archivePath,
+    const QString& dataPath,
+    int maxSize = std::numeric_limits<int>::max(),
+    ExtractResult* result = nullptr
+);
+[[nodiscard]] ExtractedBytes extractView(
+    const QString& archivePath,
+    const QString& dataPath,
+    int maxSize = std::numeric_limits<int>::max(),
+    ExtractResult* result = nullptr
+);
+// Acquires each archive once and reads its records in file-offset order. Results follow the
+// order of reads and are empty for records that are missing, oversized or unreadable.
+[[nodiscard]] QVector<ExtractedBytes> extractBatch(
+    const QVector<BatchRead>& reads,
+    int maxSize = std::numeric_limits<int>::max()
+);
+QVector<FileInfo> listFiles(const QString& archivePath, QString* error = nullptr);
 
 }
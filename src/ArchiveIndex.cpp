@@ -0,0 +1,696 @@
+#include "ArchiveIndex.h"
+#include "ArchiveAccess.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace {
+constexpr std::array<char, 4> IndexMagic {'P', 'N', 'A', 'I'};
+constexpr std::uint32_t IndexVersion = 1;
+constexpr std::uint32_t BackslashSeparatorsFlag = 1;
+constexpr std::uint32_t CompressedRecordFlag = 1;
+constexpr auto InvalidArchiveId = ~std::uint32_t {0};
+
+// On-disk layout: header, archives, owners, owner archive ids, records, UTF-8 string table.
+struct FileHeader {
+    std::array<char, 4> magic {};
+    std::uint32_t version = 0;
+    std::uint32_t archiveCount = 0;
+    std::uint32_t ownerCount = 0;
+    std::uint32_t ownerArchiveCount = 0;
+    std::uint32_t recordCount = 0;
+    std::uint32_t stringBytes = 0;
+    std::uint32_t reserved = 0;
+};
+
+struct FileString {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+struct FileArchive {
+    FileString path;
+    std::int64_t size = 0;
+    std::int64_t modified = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t reserved = 0;
+};
+
+struct FileOwner {
+    FileString name;
+    std::uint32_t firstArchive = 0;
+    std::uint32_t archiveCount = 0;
+};
+
+struct FileRecord {
+    FileString key;
+    std::uint32_t archiveId = 0;
+    std::uint32_t flags = 0;
+    std::uint64_t offset = 0;
+    std::uint32_t size = 0;
+    std::uint32_t packedSize = 0;
+};
+
+class MappedReader final {
+public:
+    MappedReader(const uchar* data, const qint64 size)
+        : m_Data(data)
+        , m_Size(size) {}
+
+    template <class T>
+    bool read(std::vector<T>& values, const std::uint32_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto bytes = static_cast<qint64>(sizeof(T)) * count;
+        if (bytes > m_Size - m_Position) {
+            return false;
+        }
+
+        values.resize(count);
+        std::memcpy(values.data(), m_Data + m_Position, static_cast<std::size_t>(bytes));
+        m_Position += bytes;
+        return true;
+    }
+
+    [[nodiscard]] const char* take(const std::uint32_t bytes) {
+        if (bytes > m_Size - m_Position) {
+            return nullptr;
+        }
+
+        const auto* const data = reinterpret_cast<const char*>(m_Data + m_Position);
+        m_Position += bytes;
+        return data;
+    }
+
+private:
+    const uchar* m_Data = nullptr;
+    qint64 m_Size = 0;
+    qint64 m_Position = 0;
+};
+
+QString archiveKey(const QString& archivePath) {
+    return QDir::fromNativeSeparators(QFileInfo(archivePath).absoluteFilePath()).toLower();
+}
+
+std::string pathKey(const QString& dataPath) {
+    return DataPathKey::fold(dataPath).toStdString();
+}
+
+QString recordPath(const QString& dataPath, const bool backslashSeparators) {
+    auto path = QString(dataPath).replace('\\', '/').trimmed();
+    while (path.startsWith('/')) {
+        path.remove(0, 1);
+    }
+    return backslashSeparators ? path.replace('/', '\\') : path;
+}
+
+struct ArchiveStamp {
+    QString path;
+    qint64 size = -1;
+    qint64 modified = -1;
+};
+
+bool hasStamp(const QFileInfo& archiveInfo, const qint64 size, const qint64 modified) {
+    return archiveInfo.isFile()
+           && archiveInfo.size() == size
+           && archiveInfo.lastModified().toMSecsSinceEpoch() == modified;
+}
+
+FileString appendString(QByteArray& strings, const QByteArray& value) {
+    const FileString string {
+        .offset = static_cast<std::uint32_t>(strings.size()),
+        .length = static_cast<std::uint32_t>(value.size()),
+    };
+    strings.append(value);
+    return string;
+}
+
+template <class T>
+bool writeValues(QSaveFile& file, const std::vector<T>& values) {
+    const auto bytes = static_cast<qint64>(values.size() * sizeof(T));
+    return file.write(reinterpret_cast<const char*>(values.data()), bytes) == bytes;
+}
+} // namespace
+
+ArchiveIndex& ArchiveIndex::instance() {
+    static ArchiveIndex index;
+    return index;
+}
+
+void ArchiveIndex::reset(const QString& profilePath) {
+    const std::unique_lock lock(m_Mutex);
+    if (profilePath == m_ProfilePath) {
+        return;
+    }
+
+    saveLocked();
+    clearLocked();
+    m_ProfilePath = profilePath;
+    loadLocked();
+}
+
+void ArchiveIndex::save() {
+    const std::unique_lock lock(m_Mutex);
+    saveLocked();
+}
+
+void ArchiveIndex::updateOwner(const QString& owner, const QStringList& archivePaths) {
+    if (isCurrent(owner, archivePaths)) {
+        return;
+    }
+
+    std::vector<ScannedArchive> scanned;
+    {
+        const std::shared_lock lock(m_Mutex);
+        for (const auto& archivePath : archivePaths) {
+            const auto it = m_ArchiveIds.constFind(archiveKey(archivePath));
+            if (it != m_ArchiveIds.cend()) {
+                const auto& archive = *m_Archives[it.value()];
+                if (hasStamp(QFileInfo(archivePath), archive.size, archive.modified)) {
+                    continue;
+                }
+            }
+            scanned.push_back({.archive = {.path = archivePath}, .records = {}});
+        }
+    }
+
+    // Directory tables are read without holding the index lock so lookups for other
+    // owners are not stalled behind archive I/O. A concurrent removeOwner may release an
+    // archive the scan pass skipped; it is then scanned, again unlocked, and re-checked.
+    std::unique_lock lock(m_Mutex, std::defer_lock);
+    while (true) {
+        for (auto& archive : scanned) {
+            archive = scanArchive(archive.archive.path);
+        }
+
+        lock.lock();
+        m_Dirty = true;
+        for (auto& archive : scanned) {
+            const auto it = m_ArchiveIds.constFind(archiveKey(archive.archive.path));
+            if (it == m_ArchiveIds.cend()) {
+                insertArchive(std::move(archive));
+                continue;
+            }
+
+            // Rescanned archives keep their id so other owners referencing them stay valid.
+            auto& indexed = *m_Archives[it.value()];
+            if (indexed.size == archive.archive.size && indexed.modified == archive.archive.modified) {
+                continue;
+            }
+            removeRecords(it.value());
+            indexed.size = archive.archive.size;
+            indexed.modified = archive.archive.modified;
+            indexed.backslashSeparators = archive.archive.backslashSeparators;
+            insertRecords(it.value(), std::move(archive.records));
+        }
+
+        scanned.clear();
+        for (const auto& archivePath : archivePaths) {
+            if (!m_ArchiveIds.contains(archiveKey(archivePath))) {
+                scanned.push_back({.archive = {.path = archivePath}, .records = {}});
+            }
+        }
+        if (scanned.empty()) {
+            break;
+        }
+        lock.unlock();
+    }
+
+    auto& entry = m_Owners[owner];
+    const auto previousIds = std::exchange(entry.archiveIds, {});
+    for (const auto archiveId : previousIds) {
+        if (m_Archives[archiveId]) {
+            m_Archives[archiveId]->owners.removeOne(owner);
+        }
+    }
+
+    entry.archivePaths = archivePaths;
+    for (const auto& archivePath : archivePaths) {
+        const auto archiveId = m_ArchiveIds.value(archiveKey(archivePath));
+        m_Archives[archiveId]->owners.append(owner);
+        entry.archiveIds.push_back(archiveId);
+    }
+
+    for (const auto archiveId : previousIds) {
+        if (m_Archives[archiveId] && m_Archives[archiveId]->owners.isEmpty()) {
+            releaseArchive(archiveId);
+        }
+    }
+
+    const std::scoped_lock stampLock(m_StampMutex);
+    m_StampsCheckedAt.insert(owner, std::chrono::steady_clock::now());
+}
+
+void ArchiveIndex::removeOwner(const QString& owner) {
+    const std::unique_lock lock(m_Mutex);
+    const auto it = m_Owners.find(owner);
+    if (it == m_Owners.end()) {
+        return;
+    }
+
+    for (const auto archiveId : it->archiveIds) {
+        if (!m_Archives[archiveId]) {
+            continue;
+        }
+        m_Archives[archiveId]->owners.removeOne(owner);
+        if (m_Archives[archiveId]->owners.isEmpty()) {
+            releaseArchive(archiveId);
+        }
+    }
+    m_Owners.erase(it);
+    m_Dirty = true;
+
+    const std::scoped_lock stampLock(m_StampMutex);
+    m_StampsCheckedAt.remove(owner);
+}
+
+QVector<ArchiveIndexLocation> ArchiveIndex::locate(const QString& owner, const QString& dataPath) const {
+    const std::shared_lock lock(m_Mutex);
+    const auto owned = m_Owners.constFind(owner);
+    const auto found = m_Paths.find(DataPathKey(dataPath));
+    if (owned == m_Owners.cend() || found == m_Paths.end()) {
+        return {};
+    }
+
+    QVector<ArchiveIndexLocation> locations;
+    for (const auto archiveId : owned->archiveIds) {
+        const auto record = std::ranges::find(found->second, archiveId, &Record::archiveId);
+        if (record == found->second.end()) {
+            continue;
+        }
+
+        const auto& archive = *m_Archives[archiveId];
+        locations.append({
+            .archivePath = archive.path,
+            .recordPath = recordPath(dataPath, archive.backslashSeparators),
+            .offset = record->offset,
+            .size = record->size,
+            .packedSize = record->packedSize,
+            .compressed = (record->flags & CompressedRecordFlag) != 0,
+        });
+    }
+    return locations;
+}
+
+bool ArchiveIndex::contains(const QString& owner, const QString& dataPath) const {
+    const std::shared_lock lock(m_Mutex);
+    return containsLocked(owner, m_Paths.find(DataPathKey(dataPath)));
+}
+
+bool ArchiveIndex::contains(const QString& owner, const DataPathKey& dataPath) const {
+    const std::shared_lock lock(m_Mutex);
+    return containsLocked(owner, m_Paths.find(dataPath));
+}
+
+bool ArchiveIndex::containsLocked(const QString& owner, const PathMap::const_iterator found) const {
+    const auto owned = m_Owners.constFind(owner);
+    if (owned == m_Owners.cend() || found == m_Paths.end()) {
+        return false;
+    }
+
+    return std::ranges::any_of(owned->archiveIds, [&](const std::uint32_t archiveId) {
+        return std::ranges::find(found->second, archiveId, &Record::archiveId) != found->second.end();
+    });
+}
+
+QStringList ArchiveIndex::owners(const DataPathKey& dataPath) const {
+    const std::shared_lock lock(m_Mutex);
+    const auto found = m_Paths.find(dataPath);
+    if (found == m_Paths.end()) {
+        return {};
+    }
+
+    QStringList owners;
+    for (const auto& record : found->second) {
+        if (const auto& archive = m_Archives[record.archiveId]) {
+            for (const auto& owner : archive->owners) {
+                if (!owners.contains(owner)) {
+                    owners.append(owner);
+                }
+            }
+        }
+    }
+    return owners;
+}
+
+bool ArchiveIndex::isCurrent(const QString& owner, const QStringList& archivePaths) const {
+    std::vector<ArchiveStamp> stamps;
+    {
+        const std::shared_lock lock(m_Mutex);
+        const auto it = m_Owners.constFind(owner);
+        if (it == m_Owners.cend() || it->archivePaths != archivePaths) {
+            return false;
+        }
+
+        const std::scoped_lock stampLock(m_StampMutex);
+        const auto checked = m_StampsCheckedAt.constFind(owner);
+        if (checked != m_StampsCheckedAt.cend() && std::chrono::steady_clock::now() - *checked < StampCheckInterval) {
+            return true;
+        }
+
+        for (const auto archiveId : it->archiveIds) {
+            const auto& archive = *m_Archives[archiveId];
+            stamps.push_back({.path = archive.path, .size = archive.size, .modified = archive.modified});
+        }
+    }
+
+    // Archives rewritten in place keep their path, so they are only caught by their stamp.
+    const bool current = std::ranges::all_of(stamps, [](const ArchiveStamp& stamp) {
+        return hasStamp(QFileInfo(stamp.path), stamp.size, stamp.modified);
+    });
+    if (current) {
+        const std::scoped_lock stampLock(m_StampMutex);
+        m_StampsCheckedAt.insert(owner, std::chrono::steady_clock::now());
+    }
+    return current;
+}
+
+ArchiveIndex::ScannedArchive ArchiveIndex::scanArchive(const QString& archivePath) {
+    const QFileInfo archiveInfo(archivePath);
+    ScannedArchive scanned {
+        .archive =
+            {.path = archivePath,
+             .size = archiveInfo.size(),
+             .modified = archiveInfo.lastModified().toMSecsSinceEpoch()},
+        .records = {},
+    };
+
+    // Archives that fail to load are indexed as empty; extraction would fail the same way.
+    QString error;
+    const auto files = ArchiveAccess::listFiles(archivePath, &error);
+    if (!error.isEmpty()) {
+        qWarning("Failed to index archive '%s': %s", qUtf8Printable(archivePath), qUtf8Printable(error));
+    }
+
+    scanned.records.reserve(files.size());
+    for (const auto& file : files) {
+        if (file.path.contains('/')) {
+            scanned.archive.backslashSeparators = false;
+        }
+        scanned.records.push_back({
+            .key = pathKey(file.path),
+            .record =
+                {.archiveId = 0,
+                 .size = file.size,
+                 .packedSize = file.packedSize,
+                 .flags = file.compressed ? CompressedRecordFlag : 0,
+                 .offset = file.offset},
+        });
+    }
+    return scanned;
+}
+
+std::uint32_t ArchiveIndex::insertArchive(ScannedArchive scanned) {
+    const auto archiveId = static_cast<std::uint32_t>(m_Archives.size());
+    m_ArchiveIds.insert(archiveKey(scanned.archive.path), archiveId);
+    m_Archives.push_back(std::make_unique<IndexedArchive>(std::move(scanned.archive)));
+    insertRecords(archiveId, std::move(scanned.records));
+    return archiveId;
+}
+
+void ArchiveIndex::insertRecords(const std::uint32_t archiveId, std::vector<ScannedRecord> records) {
+    for (auto& [key, record] : records) {
+        record.archiveId = archiveId;
+        insertRecord(std::move(key), record);
+    }
+}
+
+void ArchiveIndex::insertRecord(std::string key, const Record& record) {
+    const auto it = m_Paths.try_emplace(std::move(key)).first;
+    auto& archiveRecords = it->second;
+    if (!archiveRecords.empty() && archiveRecords.back().archiveId == record.archiveId) {
+        return;
+    }
+
+    archiveRecords.push_back(record);
+    m_Archives[record.archiveId]->recordKeys.push_back(&it->first);
+}
+
+void ArchiveIndex::removeRecords(const std::uint32_t archiveId) {
+    for (const auto* const key : std::exchange(m_Archives[archiveId]->recordKeys, {})) {
+        const auto it = m_Paths.find(*key);
+        if (it == m_Paths.end()) {
+            continue;
+        }
+
+        std::erase_if(it->second, [archiveId](const Record& record) {
+            return record.archiveId == archiveId;
+        });
+        if (it->second.empty()) {
+            m_Paths.erase(it);
+        }
+    }
+}
+
+void ArchiveIndex::releaseArchive(const std::uint32_t archiveId) {
+    auto& archive = m_Archives[archiveId];
+    if (!archive) {
+        return;
+    }
+
+    removeRecords(archiveId);
+    m_ArchiveIds.remove(archiveKey(archive->path));
+    archive.reset();
+    m_Dirty = true;
+}
+
+void ArchiveIndex::clearLocked() {
+    m_Archives.clear();
+    m_ArchiveIds.clear();
+    m_Owners.clear();
+    m_Paths.clear();
+    m_Dirty = false;
+
+    const std::scoped_lock stampLock(m_StampMutex);
+    m_StampsCheckedAt.clear();
+}
+
+void ArchiveIndex::loadLocked() {
+    if (m_ProfilePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(QDir(m_ProfilePath).filePath(IndexFileName));
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Failed to open archive index '%s'", qUtf8Printable(file.fileName()));
+        return;
+    }
+
+    const auto* const data = file.map(0, file.size());
+    if (!data) {
+        qWarning("Failed to map archive index '%s'", qUtf8Printable(file.fileName()));
+        return;
+    }
+
+    MappedReader reader(data, file.size());
+    std::vector<FileHeader> header;
+    std::vector<FileArchive> archives;
+    std::vector<FileOwner> owners;
+    std::vector<std::uint32_t> ownerArchives;
+    std::vector<FileRecord> records;
+    const char* strings = nullptr;
+    const bool valid = reader.read(header, 1)
+                       && header.front().magic == IndexMagic
+                       && header.front().version == IndexVersion
+                       && reader.read(archives, header.front().archiveCount)
+                       && reader.read(owners, header.front().ownerCount)
+                       && reader.read(ownerArchives, header.front().ownerArchiveCount)
+                       && reader.read(records, header.front().recordCount)
+                       && (strings = reader.take(header.front().stringBytes)) != nullptr;
+    if (!valid) {
+        qWarning("Ignoring unreadable archive index '%s'", qUtf8Printable(file.fileName()));
+        return;
+    }
+
+    const auto stringBytes = header.front().stringBytes;
+    const auto stringAt = [&](const FileString& string) -> std::optional<QByteArray> {
+        if (string.offset > stringBytes || string.length > stringBytes - string.offset) {
+            return std::nullopt;
+        }
+        return QByteArray(strings + string.offset, static_cast<qsizetype>(string.length));
+    };
+
+    // Archives whose size or mtime changed are left out, so only they are rescanned.
+    std::vector<std::uint32_t> archiveIds(archives.size(), InvalidArchiveId);
+    std::size_t staleCount = 0;
+    for (std::size_t i = 0; i < archives.size(); ++i) {
+        const auto& archive = archives[i];
+        const auto path = stringAt(archive.path);
+        if (!path) {
+            continue;
+        }
+
+        const auto archivePath = QString::fromUtf8(*path);
+        if (!hasStamp(QFileInfo(archivePath), archive.size, archive.modified)) {
+            ++staleCount;
+            continue;
+        }
+
+        archiveIds[i] = insertArchive({
+            .archive =
+                {.path = archivePath,
+                 .size = archive.size,
+                 .modified = archive.modified,
+                 .backslashSeparators = (archive.flags & BackslashSeparatorsFlag) != 0},
+            .records = {},
+        });
+    }
+
+    for (const auto& owner : owners) {
+        const auto name = stringAt(owner.name);
+        if (!name
+            || owner.firstArchive > ownerArchives.size()
+            || owner.archiveCount > ownerArchives.size() - owner.firstArchive) {
+            continue;
+        }
+
+        // Owners referencing a stale archive are dropped and rebuilt on their next lookup.
+        Owner entry;
+        for (std::uint32_t i = 0; i < owner.archiveCount; ++i) {
+            const auto fileId = ownerArchives[owner.firstArchive + i];
+            if (fileId >= archiveIds.size() || archiveIds[fileId] == InvalidArchiveId) {
+                break;
+            }
+            entry.archiveIds.push_back(archiveIds[fileId]);
+            entry.archivePaths.append(m_Archives[archiveIds[fileId]]->path);
+        }
+
+        if (entry.archiveIds.size() == owner.archiveCount) {
+            const auto ownerName = QString::fromUtf8(*name);
+            for (const auto archiveId : entry.archiveIds) {
+                m_Archives[archiveId]->owners.append(ownerName);
+            }
+            m_Owners.insert(ownerName, std::move(entry));
+        }
+    }
+
+    m_Paths.reserve(records.size());
+    for (const auto& record : records) {
+        if (record.archiveId >= archiveIds.size() || archiveIds[record.archiveId] == InvalidArchiveId) {
+            continue;
+        }
+        if (const auto key = stringAt(record.key)) {
+            insertRecord(
+                key->toStdString(),
+                {
+                    .archiveId = archiveIds[record.archiveId],
+                    .size = record.size,
+                    .packedSize = record.packedSize,
+                    .flags = record.flags,
+                    .offset = record.offset,
+                }
+            );
+        }
+    }
+
+    m_Dirty = staleCount > 0;
+    qDebug(
+        "Loaded archive index '%s': %zu archives, %zu stale",
+        qUtf8Printable(file.fileName()),
+        archives.size() - staleCount,
+        staleCount
+    );
+}
+
+void ArchiveIndex::saveLocked() {
+    if (!m_Dirty || m_ProfilePath.isEmpty()) {
+        return;
+    }
+
+    QByteArray strings;
+    std::vector<std::uint32_t> fileIds(m_Archives.size(), InvalidArchiveId);
+    std::vector<FileArchive> archives;
+    for (std::size_t archiveId = 0; archiveId < m_Archives.size(); ++archiveId) {
+        // Archives no owner references any more are dropped from the saved index.
+        if (const auto& archive = m_Archives[archiveId]; archive && !archive->owners.isEmpty()) {
+            fileIds[archiveId] = static_cast<std::uint32_t>(archives.size());
+            archives.push_back({
+                .path = appendString(strings, archive->path.toUtf8()),
+                .size = archive->size,
+                .modified = archive->modified,
+                .flags = archive->backslashSeparators ? BackslashSeparatorsFlag : 0,
+                .reserved = 0,
+            });
+        }
+    }
+
+    std::vector<FileOwner> owners;
+    std::vector<std::uint32_t> ownerArchives;
+    for (auto it = m_Owners.cbegin(); it != m_Owners.cend(); ++it) {
+        owners.push_back({
+            .name = appendString(strings, it.key().toUtf8()),
+            .firstArchive = static_cast<std::uint32_t>(ownerArchives.size()),
+            .archiveCount = static_cast<std::uint32_t>(it->archiveIds.size()),
+        });
+        for (const auto archiveId : it->archiveIds) {
+            ownerArchives.push_back(fileIds[archiveId]);
+        }
+    }
+
+    std::vector<FileRecord> records;
+    for (const auto& [key, archiveRecords] : m_Paths) {
+        std::optional<FileString> keyString;
+        for (const auto& record : archiveRecords) {
+            if (fileIds[record.archiveId] == InvalidArchiveId) {
+                continue;
+            }
+            if (!keyString) {
+                keyString = appendString(strings, QByteArray::fromStdString(key));
+            }
+            records.push_back({
+                .key = *keyString,
+                .archiveId = fileIds[record.archiveId],
+                .flags = record.flags,
+                .offset = record.offset,
+                .size = record.size,
+                .packedSize = record.packedSize,
+            });
+        }
+    }
+
+    const std::vector<FileHeader> header {{
+        .magic = IndexMagic,
+        .version = IndexVersion,
+        .archiveCount = static_cast<std::uint32_t>(archives.size()),
+        .ownerCount = static_cast<std::uint32_t>(owners.size()),
+        .ownerArchiveCount = static_cast<std::uint32_t>(ownerArchives.size()),
+        .recordCount = static_cast<std::uint32_t>(records.size()),
+        .stringBytes = static_cast<std::uint32_t>(strings.size()),
+        .reserved = 0,
+    }};
+
+    QSaveFile file(QDir(m_ProfilePath).filePath(IndexFileName));
+    const bool written = file.open(QIODevice::WriteOnly)
+                         && writeValues(file, header)
+                         && writeValues(file, archives)
+                         && writeValues(file, owners)
+                         && writeValues(file, ownerArchives)
+                         && writeValues(file, records)
+                         && file.write(strings) == strings.size()
+                         && file.commit();
+    if (!written) {
+        qWarning(
+            "Failed to write archive index '%s': %s",
+            qUtf8Printable(file.fileName()),
+            qUtf8Printable(file.errorString())
+        );
+        return;
+    }
+
+    m_Dirty = false;
+}
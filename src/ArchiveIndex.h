@@ -0,0 +1,116 @@
+#pragma once
+
+#include "DataPathKey.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Offsets and sizes are zero when the archive backend does not report record layout.
+struct ArchiveIndexLocation {
+    QString archivePath;
+    QString recordPath;
+    std::uint64_t offset = 0;
+    std::uint32_t size = 0;
+    std::uint32_t packedSize = 0;
+    bool compressed = false;
+};
+
+// Maps lowercased data paths to the archives that contain them. Archives are grouped
+// by owner (a mod name or GameOwner) and keep the owner's lookup-priority order. The
+// index is persisted per profile and validated against archive size and mtime on load.
+class ArchiveIndex final {
+public:
+    static constexpr auto GameOwner = "<game>";
+    static constexpr auto IndexFileName = "preview_nif_archive_index.bin";
+    static constexpr std::chrono::seconds StampCheckInterval {2};
+
+    static ArchiveIndex& instance();
+
+    // Saves the current profile's index and loads the index stored for profilePath.
+    void reset(const QString& profilePath);
+    void save();
+
+    // Rescans only archives that are new to the index or whose size or mtime changed.
+    void updateOwner(const QString& owner, const QStringList& archivePaths);
+    void removeOwner(const QString& owner);
+    // True when owner was indexed with archivePaths and none of them changed size or mtime since;
+    // archive stamps are checked at most once per StampCheckInterval.
+    [[nodiscard]] bool isCurrent(const QString& owner, const QStringList& archivePaths) const;
+
+    [[nodiscard]] QVector<ArchiveIndexLocation> locate(const QString& owner, const QString& dataPath) const;
+    [[nodiscard]] bool contains(const QString& owner, const QString& dataPath) const;
+    [[nodiscard]] bool contains(const QString& owner, const DataPathKey& dataPath) const;
+    // Every owner with an archive holding dataPath, from a single path lookup.
+    [[nodiscard]] QStringList owners(const DataPathKey& dataPath) const;
+
+private:
+    struct IndexedArchive {
+        QString path;
+        qint64 size = -1;
+        qint64 modified = -1;
+        bool backslashSeparators = true;
+        QStringList owners;
+        // Keys of the m_Paths entries holding a record of this archive, so removing its records
+        // does not walk every indexed path. Map nodes never move, so the pointers stay valid.
+        std::vector<const std::string*> recordKeys;
+    };
+
+    struct Record {
+        std::uint32_t archiveId = 0;
+        std::uint32_t size = 0;
+        std::uint32_t packedSize = 0;
+        std::uint32_t flags = 0;
+        std::uint64_t offset = 0;
+    };
+
+    struct ScannedRecord {
+        std::string key;
+        Record record;
+    };
+
+    struct ScannedArchive {
+        IndexedArchive archive;
+        std::vector<ScannedRecord> records;
+    };
+
+    struct Owner {
+        QStringList archivePaths;
+        std::vector<std::uint32_t> archiveIds;
+    };
+
+    using PathMap = std::unordered_map<std::string, std::vector<Record>, DataPathHash, DataPathEqual>;
+
+    ArchiveIndex() = default;
+
+    [[nodiscard]] static ScannedArchive scanArchive(const QString& archivePath);
+    std::uint32_t insertArchive(ScannedArchive scanned);
+    void insertRecords(std::uint32_t archiveId, std::vector<ScannedRecord> records);
+    void insertRecord(std::string key, const Record& record);
+    void removeRecords(std::uint32_t archiveId);
+    void releaseArchive(std::uint32_t archiveId);
+    [[nodiscard]] bool containsLocked(const QString& owner, PathMap::const_iterator found) const;
+    void clearLocked();
+    void loadLocked();
+    void saveLocked();
+
+    mutable std::shared_mutex m_Mutex;
+    QString m_ProfilePath;
+    bool m_Dirty = false;
+    std::vector<std::unique_ptr<IndexedArchive>> m_Archives;
+    QHash<QString, std::uint32_t> m_ArchiveIds;
+    QHash<QString, Owner> m_Owners;
+    PathMap m_Paths;
+    mutable std::mutex m_StampMutex;
+    mutable QHash<QString, std::chrono::steady_clock::time_point> m_StampsCheckedAt;
+};
@@ -0,0 +1,198 @@
+#include "ArchiveIndexer.h"
+#include "ArchiveIndex.h"
+#include "MoDataPaths.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QObject>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <uibase/imodinterface.h>
+#include <uibase/imodlist.h>
+#include <uibase/imoinfo.h>
+#include <utility>
+#include <vector>
+
+namespace {
+struct IndexJob {
+    std::uint64_t generation = 0;
+    std::atomic<int> remaining = 0;
+    QElapsedTimer timer;
+};
+
+struct ModDirectory {
+    QString modName;
+    QString modPath;
+};
+
+struct Subscriber {
+    QObject* receiver = nullptr;
+    std::function<void()> onIndexed;
+};
+
+// Updates for owners a lookup is waiting on run before the remaining background job tasks.
+constexpr int QueuedUpdatePriority = 1;
+
+std::atomic<std::uint64_t> g_Generation {0};
+std::mutex g_QueueMutex;
+QSet<QString> g_QueuedOwners;
+std::mutex g_SubscriberMutex;
+std::vector<Subscriber> g_Subscribers;
+
+QThreadPool& indexThreadPool() {
+    static QThreadPool pool;
+    // Leave half of the cores to MO2 and the preview's own loading.
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+    return pool;
+}
+
+QVector<ModDirectory> activeModDirectories(MOBase::IOrganizer* organizer) {
+    QVector<ModDirectory> mods;
+    auto* const modList = organizer->modList();
+    if (!modList) {
+        return mods;
+    }
+
+    for (const auto& modName : modList->allModsByProfilePriority()) {
+        if (!(modList->state(modName) & MOBase::IModList::STATE_ACTIVE)) {
+            continue;
+        }
+
+        if (auto* const mod = modList->getMod(modName)) {
+            mods.append({.modName = modName, .modPath = mod->absolutePath()});
+        }
+    }
+    return mods;
+}
+
+// Holding the mutex while posting keeps a receiver from being destroyed mid-call; its
+// destroyed() handler takes the same mutex to unsubscribe.
+void notifyIndexed() {
+    const std::scoped_lock lock(g_SubscriberMutex);
+    for (const auto& subscriber : g_Subscribers) {
+        QMetaObject::invokeMethod(subscriber.receiver, subscriber.onIndexed, Qt::QueuedConnection);
+    }
+}
+
+void finishJob(const std::shared_ptr<IndexJob>& job, const qsizetype ownerCount) {
+    if (--job->remaining > 0 || job->generation != g_Generation) {
+        return;
+    }
+
+    ArchiveIndex::instance().save();
+    qDebug(
+        "Indexed archives of %lld owners in %lld ms",
+        static_cast<long long>(ownerCount),
+        static_cast<long long>(job->timer.elapsed())
+    );
+    notifyIndexed();
+}
+} // namespace
+
+namespace ArchiveIndexer {
+
+void start(MOBase::IOrganizer* organizer) {
+    const auto generation = ++g_Generation;
+    if (!organizer) {
+        return;
+    }
+
+    // Only MO2 queries run here; listing each mod's archives is left to the workers.
+    const auto gameArchivePaths = MoDataPaths::archivePathsFromGame(organizer);
+    const auto mods = activeModDirectories(organizer);
+    const auto ownerCount = mods.size() + 1;
+    auto job = std::make_shared<IndexJob>();
+    job->generation = generation;
+    job->remaining = static_cast<int>(ownerCount);
+    job->timer.start();
+
+    indexThreadPool().start([job, gameArchivePaths, ownerCount] {
+        if (job->generation == g_Generation) {
+            ArchiveIndex::instance().updateOwner(ArchiveIndex::GameOwner, gameArchivePaths);
+        }
+        finishJob(job, ownerCount);
+    });
+    for (const auto& mod : mods) {
+        indexThreadPool().start([job, mod, ownerCount] {
+            if (job->generation == g_Generation) {
+                if (const auto archivePaths = MoDataPaths::archivePathsFromMod(mod.modName, mod.modPath);
+                    !archivePaths.isEmpty()) {
+                    ArchiveIndex::instance().updateOwner(mod.modName, archivePaths);
+                }
+            }
+            finishJob(job, ownerCount);
+        });
+    }
+}
+
+// An update already inside updateOwner still finishes; what it records is the archives'
+// contents, which are valid for any profile that lists them.
+void cancel() {
+    ++g_Generation;
+}
+
+void waitForPendingJobs() {
+    indexThreadPool().waitForDone();
+}
+
+bool ensureIndexed(const QString& owner, const QStringList& archivePaths) {
+    if (ArchiveIndex::instance().isCurrent(owner, archivePaths)) {
+        return true;
+    }
+
+    {
+        const std::scoped_lock lock(g_QueueMutex);
+        if (g_QueuedOwners.contains(owner)) {
+            return false;
+        }
+        g_QueuedOwners.insert(owner);
+    }
+
+    indexThreadPool().start(
+        [generation = g_Generation.load(), owner, archivePaths] {
+            if (generation == g_Generation) {
+                ArchiveIndex::instance().updateOwner(owner, archivePaths);
+            }
+
+            bool drained = false;
+            {
+                const std::scoped_lock lock(g_QueueMutex);
+                g_QueuedOwners.remove(owner);
+                drained = g_QueuedOwners.isEmpty();
+            }
+            if (drained) {
+                notifyIndexed();
+            }
+        },
+        QueuedUpdatePriority
+    );
+    return false;
+}
+
+void subscribe(QObject* receiver, std::function<void()> onIndexed) {
+    if (!receiver || !onIndexed) {
+        return;
+    }
+
+    {
+        const std::scoped_lock lock(g_SubscriberMutex);
+        g_Subscribers.push_back({.receiver = receiver, .onIndexed = std::move(onIndexed)});
+    }
+    QObject::connect(receiver, &QObject::destroyed, [receiver] {
+        const std::scoped_lock lock(g_SubscriberMutex);
+        std::erase_if(g_Subscribers, [receiver](const Subscriber& subscriber) {
+            return subscriber.receiver == receiver;
+        });
+    });
+}
+
+}
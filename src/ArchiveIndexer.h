@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class QObject;
+
+namespace MOBase {
+class IOrganizer;
+}
+
+// Fills ArchiveIndex on worker threads so the first preview does not pay for archive
+// discovery. Lookups never wait for the index; they probe archives directly instead.
+namespace ArchiveIndexer {
+
+// Gathers the game's archives and every enabled mod's directory on the calling (GUI) thread
+// and lists and indexes the mods' archives in the background. Restarting cancels the previous job.
+void start(MOBase::IOrganizer* organizer);
+// Queued and running work for the previous generation is skipped; never waits.
+void cancel();
+// Blocks until the index threads are idle; for plugin shutdown.
+void waitForPendingJobs();
+
+// Returns true when owner is indexed with archivePaths. Otherwise queues an update of owner
+// ahead of the background job and returns false; callers then probe the archives directly.
+[[nodiscard]] bool ensureIndexed(const QString& owner, const QStringList& archivePaths);
+
+// Calls onIndexed on receiver's thread after a background job or the queued updates finish,
+// so views resolved against a partial index can resolve again. Dropped with receiver.
+void subscribe(QObject* receiver, std::function<void()> onIndexed);
+
+}
@@ -0,0 +1,266 @@
+#include "ArchivePool.h"
+#include "ArchiveAccess.h"
+#include "BethesdaArchive.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+#include <libbsarch/bs_archive.h>
+#endif
+
+namespace {
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+constexpr std::size_t BsaHeaderSize = 36;
+constexpr std::size_t Ba2HeaderSize = 24;
+constexpr std::size_t EstimatedRecordBytes = 96;
+constexpr std::size_t EstimatedBa2NameLength = 64;
+constexpr std::size_t UnknownArchiveBytes = std::size_t {1} * 1024 * 1024;
+
+std::uint32_t readUint32LE(const char* data) {
+    const auto* const bytes = reinterpret_cast<const unsigned char*>(data);
+    return static_cast<std::uint32_t>(bytes[0])
+           | (static_cast<std::uint32_t>(bytes[1]) << 8)
+           | (static_cast<std::uint32_t>(bytes[2]) << 16)
+           | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+// libbsarch keeps every record and its wide-character name on the heap, so the
+// directory table size from the archive header is a good proxy for pool memory.
+std::size_t estimateDirectoryBytes(const QString& archivePath) {
+    QFile file(archivePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return UnknownArchiveBytes;
+    }
+
+    std::array<char, BsaHeaderSize> header {};
+    if (file.read(header.data(), header.size()) < static_cast<qint64>(Ba2HeaderSize)) {
+        return UnknownArchiveBytes;
+    }
+
+    if (std::memcmp(header.data(), "BSA\0", 4) == 0) {
+        const auto folderCount = readUint32LE(header.data() + 16);
+        const auto fileCount = readUint32LE(header.data() + 20);
+        const auto folderNameLength = readUint32LE(header.data() + 24);
+        const auto fileNameLength = readUint32LE(header.data() + 28);
+        return (std::size_t {folderCount} + fileCount) * EstimatedRecordBytes
+               + (std::size_t {folderNameLength} + fileNameLength) * sizeof(wchar_t);
+    }
+
+    if (std::memcmp(header.data(), "BTDX", 4) == 0) {
+        const auto fileCount = readUint32LE(header.data() + 12);
+        return std::size_t {fileCount} * (EstimatedRecordBytes + EstimatedBa2NameLength * sizeof(wchar_t));
+    }
+
+    return UnknownArchiveBytes;
+}
+#endif
+
+QString archiveKey(const QFileInfo& archiveInfo) {
+    return QDir::fromNativeSeparators(archiveInfo.absoluteFilePath()).toLower();
+}
+
+QString directoryKey(const QString& directory) {
+    auto key = QDir::fromNativeSeparators(QFileInfo(directory).absoluteFilePath()).toLower();
+    if (!key.endsWith(u'/')) {
+        key.append(u'/');
+    }
+    return key;
+}
+
+void setError(QString* error, const QString& value) {
+    if (error) {
+        *error = value;
+    }
+}
+} // namespace
+
+PooledArchive::PooledArchive(std::unique_ptr<BethesdaArchive> archive, const std::size_t estimatedBytes)
+    : m_NativeArchive(std::move(archive))
+    , m_EstimatedBytes(estimatedBytes) {}
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+PooledArchive::PooledArchive(std::unique_ptr<libbsarch::bs_archive> archive, const std::size_t estimatedBytes)
+    : m_Archive(std::move(archive))
+    , m_EstimatedBytes(estimatedBytes) {}
+#endif
+
+PooledArchive::~PooledArchive() = default;
+
+ArchivePool& ArchivePool::instance() {
+    static ArchivePool pool;
+    return pool;
+}
+
+std::shared_ptr<PooledArchive> ArchivePool::acquire(const QString& archivePath, QString* error) {
+    const QFileInfo archiveInfo(archivePath);
+    if (archivePath.isEmpty() || !archiveInfo.isFile()) {
+        setError(error, QStringLiteral("Archive file does not exist"));
+        return nullptr;
+    }
+
+    const auto key = archiveKey(archiveInfo);
+    const ArchiveStamp stamp {.size = archiveInfo.size(), .modified = archiveInfo.lastModified().toMSecsSinceEpoch()};
+
+    {
+        const std::scoped_lock lock(m_Mutex);
+        if (const auto it = m_Lookup.constFind(key); it != m_Lookup.cend()) {
+            const auto entry = it.value();
+            if (entry->stamp == stamp) {
+                m_Entries.splice(m_Entries.begin(), m_Entries, entry);
+                if (!entry->archive) {
+                    setError(error, entry->error);
+                    return nullptr;
+                }
+
+                ++m_Stats.hits;
+                setError(error, {});
+                return entry->archive;
+            }
+
+            ++m_Stats.evictions;
+            erase(entry);
+        }
+    }
+
+    QString loadError;
+    auto pooled = loadArchive(archiveInfo.absoluteFilePath(), &loadError);
+    if (!pooled) {
+        qWarning("Failed to load BSA archive '%s': %s", qUtf8Printable(archivePath), qUtf8Printable(loadError));
+
+        const std::scoped_lock lock(m_Mutex);
+        ++m_Stats.failures;
+        if (!m_Lookup.contains(key)) {
+            insert({.key = key, .stamp = stamp, .archive = nullptr, .error = loadError});
+        }
+        setError(error, loadError);
+        return nullptr;
+    }
+
+    const std::scoped_lock lock(m_Mutex);
+    ++m_Stats.opens;
+    if (const auto it = m_Lookup.constFind(key); it != m_Lookup.cend()) {
+        // Another thread finished loading the same archive first; keep the pooled copy.
+        const auto entry = it.value();
+        if (entry->stamp == stamp && entry->archive) {
+            m_Entries.splice(m_Entries.begin(), m_Entries, entry);
+            setError(error, {});
+            return entry->archive;
+        }
+        erase(entry);
+    }
+
+    insert({.key = key, .stamp = stamp, .archive = pooled, .error = {}});
+    evictOverBudget();
+    setError(error, {});
+    return pooled;
+}
+
+void ArchivePool::setMemoryBudget(const std::size_t bytes) {
+    const std::scoped_lock lock(m_Mutex);
+    m_MemoryBudget = bytes;
+    evictOverBudget();
+}
+
+void ArchivePool::setMaxOpenArchives(const std::size_t count) {
+    const std::scoped_lock lock(m_Mutex);
+    m_MaxOpenArchives = count;
+    evictOverBudget();
+}
+
+void ArchivePool::removeDirectory(const QString& directory) {
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    const auto prefix = directoryKey(directory);
+    const std::scoped_lock lock(m_Mutex);
+    for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+        const auto next = std::next(it);
+        if (it->key.startsWith(prefix)) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void ArchivePool::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    qDebug(
+        "Clearing archive pool: %llu opens, %llu hits, %llu evictions, %llu failures",
+        static_cast<unsigned long long>(m_Stats.opens),
+        static_cast<unsigned long long>(m_Stats.hits),
+        static_cast<unsigned long long>(m_Stats.evictions),
+        static_cast<unsigned long long>(m_Stats.failures)
+    );
+
+    m_Entries.clear();
+    m_Lookup.clear();
+    m_EstimatedBytes = 0;
+    m_OpenArchives = 0;
+}
+
+ArchivePoolStats ArchivePool::stats() const {
+    const std::scoped_lock lock(m_Mutex);
+    auto stats = m_Stats;
+    stats.archiveCount = static_cast<std::size_t>(m_Lookup.size());
+    stats.openArchives = m_OpenArchives;
+    stats.estimatedBytes = m_EstimatedBytes;
+    return stats;
+}
+
+std::shared_ptr<PooledArchive> ArchivePool::loadArchive(const QString& archivePath, QString* error) {
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    if (ArchiveAccess::backend() == ArchiveAccess::Backend::Libbsarch) {
+        auto archive = std::make_unique<libbsarch::bs_archive>();
+        if (!ArchiveAccess::loadArchive(*archive, archivePath, error)) {
+            return nullptr;
+        }
+        return std::make_shared<PooledArchive>(std::move(archive), estimateDirectoryBytes(archivePath));
+    }
+#endif
+
+    auto archive = BethesdaArchive::open(archivePath, error);
+    if (!archive) {
+        return nullptr;
+    }
+    const auto estimatedBytes = archive->directoryBytes();
+    return std::make_shared<PooledArchive>(std::move(archive), estimatedBytes);
+}
+
+void ArchivePool::insert(Entry entry) {
+    if (entry.archive) {
+        m_EstimatedBytes += entry.archive->estimatedBytes();
+        ++m_OpenArchives;
+    }
+
+    const auto key = entry.key;
+    m_Entries.push_front(std::move(entry));
+    m_Lookup.insert(key, m_Entries.begin());
+}
+
+void ArchivePool::evictOverBudget() {
+    while ((m_EstimatedBytes > m_MemoryBudget || m_OpenArchives > m_MaxOpenArchives) && m_Entries.size() > 1) {
+        ++m_Stats.evictions;
+        erase(std::prev(m_Entries.end()));
+    }
+}
+
+void ArchivePool::erase(const EntryList::iterator it) {
+    if (it->archive) {
+        m_EstimatedBytes -= std::min(m_EstimatedBytes, it->archive->estimatedBytes());
+        --m_OpenArchives;
+    }
+
+    m_Lookup.remove(it->key);
+    m_Entries.erase(it);
+}
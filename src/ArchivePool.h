@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+class BethesdaArchive;
+
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+namespace libbsarch {
+class bs_archive;
+}
+#endif
+
+// Holds one loaded archive from whichever backend ArchiveAccess selected.
+class PooledArchive final {
+public:
+    PooledArchive(std::unique_ptr<BethesdaArchive> archive, std::size_t estimatedBytes);
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    PooledArchive(std::unique_ptr<libbsarch::bs_archive> archive, std::size_t estimatedBytes);
+#endif
+    ~PooledArchive();
+    PooledArchive(const PooledArchive&) = delete;
+    PooledArchive(PooledArchive&&) = delete;
+    PooledArchive& operator=(const PooledArchive&) = delete;
+    PooledArchive& operator=(PooledArchive&&) = delete;
+
+    // libbsarch lookups are not thread-safe; hold the lock while using libbsarchArchive().
+    // The native reader only reads its mapping and needs no lock.
+    [[nodiscard]] std::unique_lock<std::mutex> lock() const {
+        return std::unique_lock(m_Mutex);
+    }
+    [[nodiscard]] const BethesdaArchive* nativeArchive() const noexcept {
+        return m_NativeArchive.get();
+    }
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    [[nodiscard]] libbsarch::bs_archive* libbsarchArchive() const noexcept {
+        return m_Archive.get();
+    }
+#endif
+    [[nodiscard]] std::size_t estimatedBytes() const noexcept {
+        return m_EstimatedBytes;
+    }
+
+private:
+    std::unique_ptr<BethesdaArchive> m_NativeArchive;
+#ifdef PREVIEW_NIF_WITH_LIBBSARCH
+    std::unique_ptr<libbsarch::bs_archive> m_Archive;
+#endif
+    std::size_t m_EstimatedBytes = 0;
+    mutable std::mutex m_Mutex;
+};
+
+struct ArchivePoolStats {
+    std::uint64_t opens = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t failures = 0;
+    std::size_t archiveCount = 0;
+    std::size_t openArchives = 0;
+    std::size_t estimatedBytes = 0;
+};
+
+// Process-wide cache of loaded archive directory tables, keyed by absolute path and
+// validated against the archive's size and modification time on every acquire.
+// Every loaded archive keeps a file handle and mapping open, so the pool is bounded by
+// open archives as well as by the heap its directory tables use.
+class ArchivePool final {
+public:
+    static constexpr std::size_t DefaultMemoryBudget = std::size_t {256} * 1024 * 1024;
+    static constexpr std::size_t DefaultMaxOpenArchives = 128;
+
+    static ArchivePool& instance();
+
+    [[nodiscard]] std::shared_ptr<PooledArchive> acquire(const QString& archivePath, QString* error = nullptr);
+    void setMemoryBudget(std::size_t bytes);
+    void setMaxOpenArchives(std::size_t count);
+    // Drops every archive inside directory, e.g. a reinstalled or removed mod. Archives still
+    // in use stay open until their last reader releases them.
+    void removeDirectory(const QString& directory);
+    void clear();
+    [[nodiscard]] ArchivePoolStats stats() const;
+
+private:
+    struct ArchiveStamp {
+        qint64 size = -1;
+        qint64 modified = -1;
+
+        bool operator==(const ArchiveStamp&) const = default;
+    };
+
+    struct Entry {
+        QString key;
+        ArchiveStamp stamp;
+        std::shared_ptr<PooledArchive> archive;
+        QString error;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    ArchivePool() = default;
+
+    [[nodiscard]] static std::shared_ptr<PooledArchive> loadArchive(const QString& archivePath, QString* error);
+    void insert(Entry entry);
+    void evictOverBudget();
+    void erase(EntryList::iterator it);
+
+    mutable std::mutex m_Mutex;
+    EntryList m_Entries;
+    QHash<QString, EntryList::iterator> m_Lookup;
+    std::size_t m_MemoryBudget = DefaultMemoryBudget;
+    std::size_t m_MaxOpenArchives = DefaultMaxOpenArchives;
+    std::size_t m_EstimatedBytes = 0;
+    std::size_t m_OpenArchives = 0;
+    ArchivePoolStats m_Stats;
+};
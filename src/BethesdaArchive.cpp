@@ -0,0 +1,687 @@
+#include "BethesdaArchive.h"
+#include "Lz4Frame.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+
+#include <zlib.h>
+
+namespace {
+static_assert(std::endian::native == std::endian::little, "Archive tables are read in place as little-endian");
+
+constexpr std::size_t BsaHeaderSize = 36;
+constexpr std::uint32_t BsaVersionOblivion = 103;
+constexpr std::uint32_t BsaVersionFallout3 = 104;
+constexpr std::uint32_t BsaVersionSkyrimSE = 105;
+constexpr std::uint32_t BsaIncludeDirectoryNames = 0x1;
+constexpr std::uint32_t BsaIncludeFileNames = 0x2;
+constexpr std::uint32_t BsaCompressedByDefault = 0x4;
+constexpr std::uint32_t BsaEmbedFileNames = 0x100;
+constexpr std::uint32_t BsaSizeMask = 0x3FFFFFFF;
+constexpr std::uint32_t BsaCompressionToggle = 0x40000000;
+constexpr std::uint64_t BsaFileRecordSize = 16;
+
+constexpr std::uint64_t Ba2GeneralRecordSize = 36;
+constexpr std::uint64_t Ba2TextureRecordSize = 24;
+constexpr std::uint64_t Ba2ChunkSize = 24;
+constexpr std::uint32_t Ba2Lz4BlockCompression = 3;
+
+constexpr std::size_t DdsHeaderWords = 37;
+constexpr std::size_t DdsHeaderBytes = DdsHeaderWords * sizeof(std::uint32_t);
+
+constexpr std::array<std::uint32_t, 256> Crc32Table = [] {
+    std::array<std::uint32_t, 256> table {};
+    for (std::uint32_t i = 0; i < table.size(); ++i) {
+        auto value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+        }
+        table[i] = value;
+    }
+    return table;
+}();
+
+template <class T>
+T load(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+bool fail(QString* error, const QString& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+QByteArray archivePathKey(const QString& dataPath) {
+    auto path = QString(dataPath).replace('/', '\\').trimmed().toLower();
+    while (path.startsWith('\\')) {
+        path.remove(0, 1);
+    }
+    return path.toLocal8Bit();
+}
+
+struct PathParts {
+    std::string_view folder;
+    std::string_view stem;
+    std::string_view extension;
+};
+
+// The extension keeps its leading dot, matching the BSA hash input.
+PathParts splitPath(const QByteArray& path) {
+    const std::string_view view(path.constData(), static_cast<std::size_t>(path.size()));
+    const auto slash = view.rfind('\\');
+    const auto name = slash == std::string_view::npos ? view : view.substr(slash + 1);
+    const auto folder = slash == std::string_view::npos ? std::string_view {} : view.substr(0, slash);
+    const auto dot = name.rfind('.');
+    if (dot == std::string_view::npos) {
+        return {.folder = folder, .stem = name, .extension = {}};
+    }
+    return {.folder = folder, .stem = name.substr(0, dot), .extension = name.substr(dot)};
+}
+
+std::uint32_t bsaStringHash(const std::string_view text) {
+    std::uint32_t hash = 0;
+    for (const auto character : text) {
+        hash = hash * 0x1003F + static_cast<unsigned char>(character);
+    }
+    return hash;
+}
+
+std::uint64_t bsaHash(const std::string_view stem, const std::string_view extension) {
+    std::uint64_t hash = 0;
+    const auto length = stem.size();
+    if (length > 0) {
+        hash = static_cast<unsigned char>(stem[length - 1])
+               | (length > 2 ? static_cast<std::uint32_t>(static_cast<unsigned char>(stem[length - 2])) << 8 : 0)
+               | static_cast<std::uint32_t>(length) << 16
+               | static_cast<std::uint32_t>(static_cast<unsigned char>(stem[0])) << 24;
+    }
+    if (length > 3) {
+        hash += static_cast<std::uint64_t>(bsaStringHash(stem.substr(1, length - 3))) << 32;
+    }
+    if (!extension.empty()) {
+        if (extension == ".kf") {
+            hash |= 0x80;
+        } else if (extension == ".nif") {
+            hash |= 0x8000;
+        } else if (extension == ".dds") {
+            hash |= 0x8080;
+        } else if (extension == ".wav") {
+            hash |= 0x80000000;
+        }
+        hash += static_cast<std::uint64_t>(bsaStringHash(extension)) << 32;
+    }
+    return hash;
+}
+
+std::uint32_t ba2Hash(const std::string_view text) {
+    std::uint32_t hash = 0;
+    for (const auto character : text) {
+        hash = (hash >> 8) ^ Crc32Table[(hash ^ static_cast<unsigned char>(character)) & 0xFF];
+    }
+    return hash;
+}
+
+std::uint32_t ba2Extension(std::string_view extension) {
+    if (extension.starts_with('.')) {
+        extension.remove_prefix(1);
+    }
+    std::array<char, 4> bytes {};
+    std::copy_n(extension.begin(), std::min(extension.size(), bytes.size()), bytes.begin());
+    return load<std::uint32_t>(bytes.data());
+}
+
+// Rebuilds the DDS header BA2 texture archives strip from their records; a DX10 header
+// covers every DXGI format the archive can store.
+void writeDdsHeader(
+    char* destination,
+    const std::uint32_t width,
+    const std::uint32_t height,
+    const std::uint32_t mipCount,
+    const std::uint32_t dxgiFormat,
+    const bool cubemap
+) {
+    constexpr std::uint32_t DdsMagic = 0x20534444;
+    constexpr std::uint32_t Dx10FourCC = 0x30315844;
+    constexpr std::uint32_t RequiredFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+    constexpr std::uint32_t CapsTexture = 0x1000;
+    constexpr std::uint32_t CapsComplex = 0x8;
+    constexpr std::uint32_t CapsMipmap = 0x400000;
+    constexpr std::uint32_t Caps2Cubemap = 0xFE00;
+    constexpr std::uint32_t Texture2D = 3;
+    constexpr std::uint32_t MiscTextureCube = 0x4;
+
+    std::array<std::uint32_t, DdsHeaderWords> header {};
+    header[0] = DdsMagic;
+    header[1] = 124;
+    header[2] = RequiredFlags;
+    header[3] = height;
+    header[4] = width;
+    header[7] = mipCount;
+    header[19] = 32;
+    header[20] = 0x4;
+    header[21] = Dx10FourCC;
+    header[27] = CapsTexture | (mipCount > 1 ? CapsComplex | CapsMipmap : 0) | (cubemap ? CapsComplex : 0);
+    header[28] = cubemap ? Caps2Cubemap : 0;
+    header[32] = dxgiFormat;
+    header[33] = Texture2D;
+    header[34] = cubemap ? MiscTextureCube : 0;
+    header[35] = 1;
+    std::memcpy(destination, header.data(), DdsHeaderBytes);
+}
+} // namespace
+
+std::unique_ptr<BethesdaArchive> BethesdaArchive::open(const QString& archivePath, QString* error) {
+    std::unique_ptr<BethesdaArchive> archive(new BethesdaArchive());
+    archive->m_File.setFileName(archivePath);
+    if (!archive->m_File.open(QIODevice::ReadOnly)) {
+        fail(error, archive->m_File.errorString());
+        return nullptr;
+    }
+
+    archive->m_Size = static_cast<std::uint64_t>(archive->m_File.size());
+    if (archive->m_Size < 4) {
+        fail(error, QStringLiteral("Archive is too small"));
+        return nullptr;
+    }
+
+    archive->m_Data = archive->m_File.map(0, archive->m_File.size());
+    if (!archive->m_Data) {
+        fail(error, archive->m_File.errorString());
+        return nullptr;
+    }
+
+    const std::string_view magic(archive->at(0), 4);
+    bool parsed = false;
+    if (magic == std::string_view("BSA\0", 4)) {
+        parsed = archive->parseBsa(error);
+    } else if (magic == "BTDX") {
+        parsed = archive->parseBa2(error);
+    } else {
+        fail(error, QStringLiteral("Unknown archive format"));
+    }
+
+    return parsed ? std::move(archive) : nullptr;
+}
+
+BethesdaArchive::~BethesdaArchive() = default;
+
+std::optional<BethesdaArchiveEntry> BethesdaArchive::find(const QString& dataPath) const {
+    const auto path = archivePathKey(dataPath);
+    if (path.isEmpty()) {
+        return std::nullopt;
+    }
+    return m_Format == Format::Bsa ? findBsa(path) : findBa2(path);
+}
+
+std::vector<BethesdaArchiveFile> BethesdaArchive::files(QString* error) const {
+    std::vector<BethesdaArchiveFile> files;
+    if (m_Format == Format::Bsa) {
+        if ((m_BsaFlags & BsaIncludeDirectoryNames) == 0 || (m_BsaFlags & BsaIncludeFileNames) == 0) {
+            fail(error, QStringLiteral("Archive does not store file names"));
+            return {};
+        }
+
+        // File records for all folders are followed by one block of NUL-terminated file names.
+        auto name = m_FolderRecords
+                    + bsaFolderStride() * m_FolderCount
+                    + m_FolderCount
+                    + m_FolderNameBytes
+                    + BsaFileRecordSize * m_FileCount;
+        const auto namesEnd = name + m_FileNameBytes;
+        if (!contains(name, m_FileNameBytes)) {
+            fail(error, QStringLiteral("Truncated file name table"));
+            return {};
+        }
+
+        files.reserve(m_FileCount);
+        for (std::uint32_t folder = 0; folder < m_FolderCount; ++folder) {
+            const auto folderRecord = m_FolderRecords + bsaFolderStride() * folder;
+            const auto records = bsaFileRecords(folderRecord);
+            if (!records) {
+                fail(error, QStringLiteral("Invalid folder record"));
+                return {};
+            }
+
+            // The folder name is a length-prefixed, NUL-terminated string before its file records.
+            const auto folderBlock = bsaFolderOffset(folderRecord) - m_FileNameBytes;
+            const auto folderLength = static_cast<unsigned char>(*at(folderBlock));
+            const auto folderName = QString::fromLocal8Bit(
+                at(folderBlock + 1),
+                std::max<unsigned>(folderLength, 1) - 1
+            );
+            const auto fileCount = load<std::uint32_t>(at(folderRecord + 8));
+
+            for (std::uint32_t file = 0; file < fileCount; ++file) {
+                const auto nameEnd = std::find(at(name), at(namesEnd), '\0');
+                if (nameEnd == at(namesEnd)) {
+                    fail(error, QStringLiteral("Truncated file name table"));
+                    return {};
+                }
+
+                const auto record = *records + BsaFileRecordSize * file;
+                const auto rawSize = load<std::uint32_t>(at(record + 8));
+                const bool compressed = ((m_BsaFlags & BsaCompressedByDefault) != 0)
+                                        != ((rawSize & BsaCompressionToggle) != 0);
+                files.push_back({
+                    .path = folderName + '\\' + QString::fromLocal8Bit(at(name), nameEnd - at(name)),
+                    .entry =
+                        {.offset = load<std::uint32_t>(at(record + 12)),
+                         .packedSize = rawSize & BsaSizeMask,
+                         .size = 0,
+                         .compressed = compressed,
+                         .textureRecord = 0},
+                });
+                name += static_cast<std::uint64_t>(nameEnd - at(name)) + 1;
+            }
+        }
+        return files;
+    }
+
+    auto record = m_Ba2Records;
+    auto name = m_Ba2NameTable;
+    files.reserve(m_Ba2Keys.size());
+    for (std::size_t file = 0; file < m_Ba2Keys.size(); ++file) {
+        if (!contains(name, 2) || !contains(name + 2, load<std::uint16_t>(at(name)))) {
+            fail(error, QStringLiteral("Truncated file name table"));
+            return {};
+        }
+
+        const auto nameLength = load<std::uint16_t>(at(name));
+        const auto entry = ba2Entry(record);
+        if (!entry) {
+            fail(error, QStringLiteral("Invalid file record"));
+            return {};
+        }
+
+        files.push_back({.path = QString::fromLocal8Bit(at(name + 2), nameLength), .entry = *entry});
+        name += 2 + nameLength;
+        record += ba2RecordSize(record);
+    }
+    return files;
+}
+
+bool BethesdaArchive::read(const BethesdaArchiveEntry& entry, const std::span<char> destination, QString* error) const {
+    if (destination.size() != entry.size) {
+        return fail(error, QStringLiteral("Destination does not match the record size"));
+    }
+    if (m_Format == Format::Ba2Textures) {
+        return readTexture(entry, destination, error);
+    }
+    if (!contains(entry.offset, entry.packedSize)) {
+        return fail(error, QStringLiteral("Record data lies outside the archive"));
+    }
+
+    const std::span source(at(entry.offset), entry.packedSize);
+    if (!entry.compressed) {
+        if (source.size() != destination.size()) {
+            return fail(error, QStringLiteral("Stored record size does not match"));
+        }
+        std::ranges::copy(source, destination.begin());
+        return true;
+    }
+    return decompress(source, destination, error);
+}
+
+std::span<const char> BethesdaArchive::mappedBytes(const BethesdaArchiveEntry& entry) const {
+    if (entry.compressed || m_Format == Format::Ba2Textures || !contains(entry.offset, entry.size)) {
+        return {};
+    }
+    return {at(entry.offset), entry.size};
+}
+
+std::size_t BethesdaArchive::directoryBytes() const noexcept {
+    return sizeof(*this) + m_Ba2Keys.capacity() * sizeof(Ba2Key);
+}
+
+bool BethesdaArchive::parseBsa(QString* error) {
+    m_Format = Format::Bsa;
+    if (!contains(0, BsaHeaderSize)) {
+        return fail(error, QStringLiteral("Truncated BSA header"));
+    }
+
+    m_BsaVersion = load<std::uint32_t>(at(4));
+    if (m_BsaVersion != BsaVersionOblivion
+        && m_BsaVersion != BsaVersionFallout3
+        && m_BsaVersion != BsaVersionSkyrimSE) {
+        return fail(error, QStringLiteral("Unsupported BSA version %1").arg(m_BsaVersion));
+    }
+
+    m_FolderRecords = load<std::uint32_t>(at(8));
+    m_BsaFlags = load<std::uint32_t>(at(12));
+    m_FolderCount = load<std::uint32_t>(at(16));
+    m_FileCount = load<std::uint32_t>(at(20));
+    m_FolderNameBytes = load<std::uint32_t>(at(24));
+    m_FileNameBytes = load<std::uint32_t>(at(28));
+    m_Compression = m_BsaVersion == BsaVersionSkyrimSE ? Compression::Lz4Frame : Compression::Zlib;
+
+    if (!contains(m_FolderRecords, bsaFolderStride() * m_FolderCount)) {
+        return fail(error, QStringLiteral("Truncated BSA folder records"));
+    }
+    return true;
+}
+
+bool BethesdaArchive::parseBa2(QString* error) {
+    constexpr std::uint64_t Ba2HeaderSize = 24;
+    if (!contains(0, Ba2HeaderSize)) {
+        return fail(error, QStringLiteral("Truncated BA2 header"));
+    }
+
+    const auto version = load<std::uint32_t>(at(4));
+    std::uint64_t recordStart = Ba2HeaderSize;
+    switch (version) {
+        case 1:
+        case 7:
+        case 8: break;
+        case 2: recordStart = 32; break;
+        case 3: recordStart = 36; break;
+        default: return fail(error, QStringLiteral("Unsupported BA2 version %1").arg(version));
+    }
+    if (!contains(0, recordStart)) {
+        return fail(error, QStringLiteral("Truncated BA2 header"));
+    }
+    if (version == 3 && load<std::uint32_t>(at(32)) == Ba2Lz4BlockCompression) {
+        m_Compression = Compression::Lz4Block;
+    }
+
+    const std::string_view type(at(8), 4);
+    if (type == "GNRL") {
+        m_Format = Format::Ba2General;
+    } else if (type == "DX10") {
+        m_Format = Format::Ba2Textures;
+    } else {
+        return fail(error, QStringLiteral("Unsupported BA2 type '%1'").arg(QString::fromLatin1(type.data(), 4)));
+    }
+
+    const auto fileCount = load<std::uint32_t>(at(12));
+    m_Ba2NameTable = load<std::uint64_t>(at(16));
+    m_Ba2Records = recordStart;
+
+    // BA2 records are not sorted, so one pass builds a sorted hash table over them.
+    m_Ba2Keys.reserve(fileCount);
+    auto record = recordStart;
+    for (std::uint32_t file = 0; file < fileCount; ++file) {
+        const auto recordSize = ba2RecordSize(record);
+        if (recordSize == 0) {
+            return fail(error, QStringLiteral("Truncated BA2 file records"));
+        }
+
+        m_Ba2Keys.push_back({
+            .directoryHash = load<std::uint32_t>(at(record + 8)),
+            .nameHash = load<std::uint32_t>(at(record)),
+            .extension = load<std::uint32_t>(at(record + 4)),
+            .record = record,
+        });
+        record += recordSize;
+    }
+
+    std::ranges::sort(m_Ba2Keys, {}, [](const Ba2Key& key) {
+        return std::tuple(key.directoryHash, key.nameHash, key.extension);
+    });
+    return true;
+}
+
+std::optional<BethesdaArchiveEntry> BethesdaArchive::findBsa(const QByteArray& path) const {
+    const auto parts = splitPath(path);
+    const auto folderHash = bsaHash(parts.folder, {});
+    const auto fileHash = bsaHash(parts.stem, parts.extension);
+
+    // Folder and file records are stored sorted by hash, so both levels are binary searched in place.
+    const auto stride = bsaFolderStride();
+    std::uint32_t low = 0;
+    std::uint32_t high = m_FolderCount;
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        const auto hash = load<std::uint64_t>(at(m_FolderRecords + stride * middle));
+        if (hash == folderHash) {
+            const auto folderRecord = m_FolderRecords + stride * middle;
+            const auto records = bsaFileRecords(folderRecord);
+            if (!records) {
+                return std::nullopt;
+            }
+
+            std::uint32_t fileLow = 0;
+            std::uint32_t fileHigh = load<std::uint32_t>(at(folderRecord + 8));
+            while (fileLow < fileHigh) {
+                const auto fileMiddle = fileLow + (fileHigh - fileLow) / 2;
+                const auto record = *records + BsaFileRecordSize * fileMiddle;
+                const auto recordHash = load<std::uint64_t>(at(record));
+                if (recordHash == fileHash) {
+                    return bsaEntry(record);
+                }
+                if (recordHash < fileHash) {
+                    fileLow = fileMiddle + 1;
+                } else {
+                    fileHigh = fileMiddle;
+                }
+            }
+            return std::nullopt;
+        }
+
+        if (hash < folderHash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<BethesdaArchiveEntry> BethesdaArchive::findBa2(const QByteArray& path) const {
+    const auto parts = splitPath(path);
+    const auto key = std::tuple(ba2Hash(parts.folder), ba2Hash(parts.stem), ba2Extension(parts.extension));
+    const auto it = std::ranges::lower_bound(m_Ba2Keys, key, {}, [](const Ba2Key& entry) {
+        return std::tuple(entry.directoryHash, entry.nameHash, entry.extension);
+    });
+    if (it == m_Ba2Keys.end() || std::tuple(it->directoryHash, it->nameHash, it->extension) != key) {
+        return std::nullopt;
+    }
+    return ba2Entry(it->record);
+}
+
+std::optional<BethesdaArchiveEntry> BethesdaArchive::bsaEntry(const std::uint64_t record) const {
+    const auto rawSize = load<std::uint32_t>(at(record + 8));
+    const bool compressed = ((m_BsaFlags & BsaCompressedByDefault) != 0) != ((rawSize & BsaCompressionToggle) != 0);
+    std::uint64_t offset = load<std::uint32_t>(at(record + 12));
+    std::uint64_t stored = rawSize & BsaSizeMask;
+
+    if (m_BsaVersion != BsaVersionOblivion && (m_BsaFlags & BsaEmbedFileNames) != 0) {
+        if (!contains(offset, 1)) {
+            return std::nullopt;
+        }
+        const auto nameBytes = 1 + static_cast<std::uint64_t>(static_cast<unsigned char>(*at(offset)));
+        if (nameBytes > stored) {
+            return std::nullopt;
+        }
+        offset += nameBytes;
+        stored -= nameBytes;
+    }
+
+    std::uint64_t size = stored;
+    if (compressed) {
+        if (stored < 4 || !contains(offset, 4)) {
+            return std::nullopt;
+        }
+        size = load<std::uint32_t>(at(offset));
+        offset += 4;
+        stored -= 4;
+    }
+
+    if (!contains(offset, stored)) {
+        return std::nullopt;
+    }
+    return BethesdaArchiveEntry {
+        .offset = offset,
+        .packedSize = static_cast<std::uint32_t>(stored),
+        .size = static_cast<std::uint32_t>(size),
+        .compressed = compressed,
+        .textureRecord = 0,
+    };
+}
+
+std::uint64_t BethesdaArchive::bsaFolderStride() const noexcept {
+    return m_BsaVersion == BsaVersionSkyrimSE ? 24 : 16;
+}
+
+std::uint64_t BethesdaArchive::bsaFolderOffset(const std::uint64_t folder) const {
+    return m_BsaVersion == BsaVersionSkyrimSE ? load<std::uint64_t>(at(folder + 16))
+                                              : load<std::uint32_t>(at(folder + 12));
+}
+
+std::optional<std::uint64_t> BethesdaArchive::bsaFileRecords(const std::uint64_t folder) const {
+    const auto fileCount = load<std::uint32_t>(at(folder + 8));
+    const auto offset = bsaFolderOffset(folder);
+    // Folder offsets include the file name block size for historical reasons.
+    if (offset < m_FileNameBytes) {
+        return std::nullopt;
+    }
+
+    auto records = offset - m_FileNameBytes;
+    if ((m_BsaFlags & BsaIncludeDirectoryNames) != 0) {
+        if (!contains(records, 1)) {
+            return std::nullopt;
+        }
+        records += 1 + static_cast<std::uint64_t>(static_cast<unsigned char>(*at(records)));
+    }
+
+    if (!contains(records, BsaFileRecordSize * fileCount)) {
+        return std::nullopt;
+    }
+    return records;
+}
+
+std::optional<BethesdaArchiveEntry> BethesdaArchive::ba2Entry(const std::uint64_t record) const {
+    if (m_Format == Format::Ba2General) {
+        const auto packedSize = load<std::uint32_t>(at(record + 24));
+        const auto size = load<std::uint32_t>(at(record + 28));
+        return BethesdaArchiveEntry {
+            .offset = load<std::uint64_t>(at(record + 16)),
+            .packedSize = packedSize != 0 ? packedSize : size,
+            .size = size,
+            .compressed = packedSize != 0,
+            .textureRecord = 0,
+        };
+    }
+
+    const auto chunkCount = static_cast<unsigned char>(*at(record + 13));
+    BethesdaArchiveEntry entry {
+        .offset = 0,
+        .packedSize = 0,
+        .size = DdsHeaderBytes,
+        .compressed = false,
+        .textureRecord = record,
+    };
+    for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const auto chunkRecord = record + Ba2TextureRecordSize + Ba2ChunkSize * chunk;
+        const auto packedSize = load<std::uint32_t>(at(chunkRecord + 8));
+        const auto size = load<std::uint32_t>(at(chunkRecord + 12));
+        if (chunk == 0) {
+            entry.offset = load<std::uint64_t>(at(chunkRecord));
+        }
+        entry.packedSize += packedSize != 0 ? packedSize : size;
+        entry.size += size;
+        entry.compressed = entry.compressed || packedSize != 0;
+    }
+    return entry;
+}
+
+std::uint64_t BethesdaArchive::ba2RecordSize(const std::uint64_t record) const {
+    if (m_Format == Format::Ba2General) {
+        return contains(record, Ba2GeneralRecordSize) ? Ba2GeneralRecordSize : 0;
+    }
+    if (!contains(record, Ba2TextureRecordSize)) {
+        return 0;
+    }
+
+    const auto size = Ba2TextureRecordSize + Ba2ChunkSize * static_cast<unsigned char>(*at(record + 13));
+    return contains(record, size) ? size : 0;
+}
+
+bool BethesdaArchive::readTexture(
+    const BethesdaArchiveEntry& entry,
+    const std::span<char> destination,
+    QString* error
+) const {
+    const auto record = entry.textureRecord;
+    writeDdsHeader(
+        destination.data(),
+        load<std::uint16_t>(at(record + 18)),
+        load<std::uint16_t>(at(record + 16)),
+        static_cast<unsigned char>(*at(record + 20)),
+        static_cast<unsigned char>(*at(record + 21)),
+        *at(record + 22) != 0
+    );
+
+    // Chunks hold consecutive mip ranges, so concatenating them restores the DDS payload.
+    auto position = DdsHeaderBytes;
+    const auto chunkCount = static_cast<unsigned char>(*at(record + 13));
+    for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const auto chunkRecord = record + Ba2TextureRecordSize + Ba2ChunkSize * chunk;
+        const auto offset = load<std::uint64_t>(at(chunkRecord));
+        const auto packedSize = load<std::uint32_t>(at(chunkRecord + 8));
+        const auto size = load<std::uint32_t>(at(chunkRecord + 12));
+        const auto stored = packedSize != 0 ? packedSize : size;
+        if (!contains(offset, stored) || size > destination.size() - position) {
+            return fail(error, QStringLiteral("Texture chunk lies outside the archive"));
+        }
+
+        const auto output = destination.subspan(position, size);
+        if (packedSize == 0) {
+            std::memcpy(output.data(), at(offset), size);
+        } else if (!decompress({at(offset), packedSize}, output, error)) {
+            return false;
+        }
+        position += size;
+    }
+    return position == destination.size() || fail(error, QStringLiteral("Texture chunks do not match the record size"));
+}
+
+bool BethesdaArchive::decompress(
+    const std::span<const char> source,
+    const std::span<char> destination,
+    QString* error
+) const {
+    switch (m_Compression) {
+        case Compression::Zlib: {
+            auto length = static_cast<uLongf>(destination.size());
+            const auto result = uncompress(
+                reinterpret_cast<Bytef*>(destination.data()),
+                &length,
+                reinterpret_cast<const Bytef*>(source.data()),
+                static_cast<uLong>(source.size())
+            );
+            if (result != Z_OK || length != destination.size()) {
+                return fail(error, QStringLiteral("Failed to inflate record (zlib error %1)").arg(result));
+            }
+            return true;
+        }
+        case Compression::Lz4Frame:
+            return Lz4Frame::decompressFrame(
+                source.data(),
+                source.size(),
+                destination.data(),
+                destination.size(),
+                error
+            );
+        case Compression::Lz4Block: {
+            std::size_t written = 0;
+            return Lz4Frame::decompressBlock(
+                       source.data(),
+                       source.size(),
+                       destination.data(),
+                       destination.size(),
+                       &written,
+                       error
+                   )
+                   && (written == destination.size() || fail(error, QStringLiteral("LZ4 block size does not match")));
+        }
+    }
+    return fail(error, QStringLiteral("Unknown compression"));
+}
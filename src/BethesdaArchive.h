@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct BethesdaArchiveEntry {
+    std::uint64_t offset = 0;
+    std::uint32_t packedSize = 0;
+    std::uint32_t size = 0;
+    bool compressed = false;
+    // Position of the BA2 texture record in the mapped file; zero for other archives.
+    std::uint64_t textureRecord = 0;
+};
+
+struct BethesdaArchiveFile {
+    QString path;
+    BethesdaArchiveEntry entry;
+};
+
+// Reads TES4/FO3/SSE BSA and FO4 GNRL/DX10 BA2 archives from a memory-mapped file.
+// Lookups hash the data path the same way the game does and search the mapped tables
+// directly; the archive keeps no per-file heap structures except the BA2 hash table.
+class BethesdaArchive final {
+public:
+    [[nodiscard]] static std::unique_ptr<BethesdaArchive> open(const QString& archivePath, QString* error = nullptr);
+
+    ~BethesdaArchive();
+    BethesdaArchive(const BethesdaArchive&) = delete;
+    BethesdaArchive(BethesdaArchive&&) = delete;
+    BethesdaArchive& operator=(const BethesdaArchive&) = delete;
+    BethesdaArchive& operator=(BethesdaArchive&&) = delete;
+
+    [[nodiscard]] std::optional<BethesdaArchiveEntry> find(const QString& dataPath) const;
+    // BSA entries here point at the raw record and have a zero size; embedded names and
+    // compressed sizes are only resolved by find().
+    [[nodiscard]] std::vector<BethesdaArchiveFile> files(QString* error = nullptr) const;
+
+    // Writes exactly entry.size bytes into destination, decompressing as needed.
+    bool read(const BethesdaArchiveEntry& entry, std::span<char> destination, QString* error = nullptr) const;
+    // Returns the stored bytes of an uncompressed record without copying.
+    [[nodiscard]] std::span<const char> mappedBytes(const BethesdaArchiveEntry& entry) const;
+
+    [[nodiscard]] std::size_t directoryBytes() const noexcept;
+
+private:
+    enum class Format {
+        Bsa,
+        Ba2General,
+        Ba2Textures
+    };
+
+    enum class Compression {
+        Zlib,
+        Lz4Frame,
+        Lz4Block
+    };
+
+    struct Ba2Key {
+        std::uint32_t directoryHash = 0;
+        std::uint32_t nameHash = 0;
+        std::uint32_t extension = 0;
+        std::uint64_t record = 0;
+    };
+
+    BethesdaArchive() = default;
+
+    bool parseBsa(QString* error);
+    bool parseBa2(QString* error);
+    [[nodiscard]] std::optional<BethesdaArchiveEntry> findBsa(const QByteArray& path) const;
+    [[nodiscard]] std::optional<BethesdaArchiveEntry> findBa2(const QByteArray& path) const;
+    [[nodiscard]] std::optional<BethesdaArchiveEntry> bsaEntry(std::uint64_t record) const;
+    [[nodiscard]] std::uint64_t bsaFolderStride() const noexcept;
+    [[nodiscard]] std::uint64_t bsaFolderOffset(std::uint64_t folder) const;
+    [[nodiscard]] std::optional<std::uint64_t> bsaFileRecords(std::uint64_t folder) const;
+    [[nodiscard]] std::optional<BethesdaArchiveEntry> ba2Entry(std::uint64_t record) const;
+    [[nodiscard]] std::uint64_t ba2RecordSize(std::uint64_t record) const;
+    bool readTexture(const BethesdaArchiveEntry& entry, std::span<char> destination, QString* error) const;
+    bool decompress(std::span<const char> source, std::span<char> destination, QString* error) const;
+
+    [[nodiscard]] bool contains(std::uint64_t offset, std::uint64_t size) const noexcept {
+        return offset <= m_Size && size <= m_Size - offset;
+    }
+    [[nodiscard]] const char* at(const std::uint64_t offset) const noexcept {
+        return reinterpret_cast<const char*>(m_Data) + offset;
+    }
+
+    QFile m_File;
+    const uchar* m_Data = nullptr;
+    std::uint64_t m_Size = 0;
+    Format m_Format = Format::Bsa;
+    Compression m_Compression = Compression::Zlib;
+
+    std::uint64_t m_FolderRecords = 0;
+    std::uint32_t m_BsaVersion = 0;
+    std::uint32_t m_BsaFlags = 0;
+    std::uint32_t m_FolderCount = 0;
+    std::uint32_t m_FileCount = 0;
+    std::uint32_t m_FolderNameBytes = 0;
+    std::uint32_t m_FileNameBytes = 0;
+
+    std::uint64_t m_Ba2Records = 0;
+    std::uint64_t m_Ba2NameTable = 0;
+    std::vector<Ba2Key> m_Ba2Keys;
+};
@@ -0,0 +1,118 @@
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+constexpr std::uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+constexpr std::size_t StripeSize = 32;
+
+// Archives and NIFs are little-endian on every platform the plugin ships for.
+std::uint64_t load64(const char* data) {
+    std::uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::uint32_t load32(const char* data) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::uint64_t round(std::uint64_t lane, const std::uint64_t input) {
+    lane += input * Prime2;
+    return std::rotl(lane, 31) * Prime1;
+}
+
+std::uint64_t mergeRound(const std::uint64_t hash, const std::uint64_t lane) {
+    return (hash ^ round(0, lane)) * Prime1 + Prime4;
+}
+
+void consumeStripe(std::array<std::uint64_t, 4>& lanes, const char* stripe) {
+    for (std::size_t i = 0; i < lanes.size(); ++i) {
+        lanes[i] = round(lanes[i], load64(stripe + i * 8));
+    }
+}
+} // namespace
+
+namespace ContentHash {
+
+Xxh64::Xxh64(const std::uint64_t seed)
+    : m_Seed(seed)
+    , m_Lanes {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1} {}
+
+void Xxh64::update(const char* data, std::size_t size) {
+    m_Length += size;
+
+    if (m_Buffered > 0) {
+        const auto fill = std::min(size, StripeSize - m_Buffered);
+        std::memcpy(m_Buffer.data() + m_Buffered, data, fill);
+        m_Buffered += fill;
+        data += fill;
+        size -= fill;
+        if (m_Buffered < StripeSize) {
+            return;
+        }
+        consumeStripe(m_Lanes, m_Buffer.data());
+        m_Buffered = 0;
+    }
+
+    for (; size >= StripeSize; data += StripeSize, size -= StripeSize) {
+        consumeStripe(m_Lanes, data);
+    }
+
+    std::memcpy(m_Buffer.data(), data, size);
+    m_Buffered = size;
+}
+
+std::uint64_t Xxh64::digest() const {
+    std::uint64_t hash = 0;
+    if (m_Length >= StripeSize) {
+        hash = std::rotl(m_Lanes[0], 1) + std::rotl(m_Lanes[1], 7) + std::rotl(m_Lanes[2], 12)
+               + std::rotl(m_Lanes[3], 18);
+        for (const auto lane : m_Lanes) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = m_Seed + Prime5;
+    }
+    hash += m_Length;
+
+    const char* tail = m_Buffer.data();
+    auto remaining = m_Buffered;
+    for (; remaining >= 8; tail += 8, remaining -= 8) {
+        hash ^= round(0, load64(tail));
+        hash = std::rotl(hash, 27) * Prime1 + Prime4;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<std::uint64_t>(load32(tail)) * Prime1;
+        hash = std::rotl(hash, 23) * Prime2 + Prime3;
+        tail += 4;
+        remaining -= 4;
+    }
+    for (; remaining > 0; ++tail, --remaining) {
+        hash ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*tail)) * Prime5;
+        hash = std::rotl(hash, 11) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::uint64_t xxh64(const char* data, const std::size_t size, const std::uint64_t seed) {
+    Xxh64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+}
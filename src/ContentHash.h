@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// XXH64 content fingerprints. Streaming input produces the same digest as hashing the
+// concatenated bytes in one call.
+namespace ContentHash {
+
+class Xxh64 final {
+public:
+    explicit Xxh64(std::uint64_t seed = 0);
+
+    void update(const char* data, std::size_t size);
+    [[nodiscard]] std::uint64_t digest() const;
+
+private:
+    std::uint64_t m_Seed = 0;
+    std::array<std::uint64_t, 4> m_Lanes {};
+    std::array<char, 32> m_Buffer {};
+    std::size_t m_Buffered = 0;
+    std::uint64_t m_Length = 0;
+};
+
+[[nodiscard]] std::uint64_t xxh64(const char* data, std::size_t size, std::uint64_t seed = 0);
+
+}
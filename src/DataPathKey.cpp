@@ -0,0 +1,48 @@
+#include "DataPathKey.h"
+
+// Plain ASCII paths, nearly all of them, are folded in one pass without temporary strings.
+DataPathKey::DataPathKey(const QStringView path) {
+    const auto trimmed = path.trimmed();
+    m_Utf8.reserve(static_cast<std::size_t>(trimmed.size()));
+    for (const auto c : trimmed) {
+        const auto unicode = c.unicode();
+        if (unicode >= 0x80) {
+            m_Utf8 = fold(path).toStdString();
+            break;
+        }
+
+        auto folded = static_cast<char>(unicode);
+        if (folded == '\\') {
+            folded = '/';
+        } else if (folded >= 'A' && folded <= 'Z') {
+            folded = static_cast<char>(folded - 'A' + 'a');
+        }
+        if (folded != '/' || !m_Utf8.empty()) {
+            m_Utf8.push_back(folded);
+        }
+    }
+
+    if (!m_Utf8.empty()) {
+        m_Hash = hashUtf8(m_Utf8);
+    }
+}
+
+// Archive records use backslashes regardless of platform, so separators are folded
+// explicitly instead of through QDir::fromNativeSeparators.
+QString DataPathKey::fold(const QStringView path) {
+    auto folded = path.trimmed().toString().replace('\\', '/');
+    qsizetype start = 0;
+    while (start < folded.size() && folded[start] == '/') {
+        ++start;
+    }
+    return folded.remove(0, start).toLower();
+}
+
+std::uint64_t DataPathKey::hashUtf8(const std::string_view path) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const auto c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
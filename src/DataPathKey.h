@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// A data path folded once (forward slashes, no leading slash, lowercase) and kept as UTF-8
+// with its 64-bit hash, so hashing and comparing never fold again. Keys are plain values
+// and are freed with the containers that hold them.
+class DataPathKey final {
+public:
+    DataPathKey() = default;
+    // Folds separators and case only; texture paths are normalized by the caller.
+    explicit DataPathKey(QStringView path);
+
+    [[nodiscard]] static QString fold(QStringView path);
+    // FNV-1a over folded UTF-8, shared with maps that store folded paths as std::string.
+    [[nodiscard]] static std::uint64_t hashUtf8(std::string_view path) noexcept;
+
+    [[nodiscard]] bool isEmpty() const noexcept {
+        return m_Utf8.empty();
+    }
+    [[nodiscard]] QString path() const {
+        return QString::fromStdString(m_Utf8);
+    }
+    [[nodiscard]] std::string_view utf8() const noexcept {
+        return m_Utf8;
+    }
+    [[nodiscard]] std::uint64_t hash() const noexcept {
+        return m_Hash;
+    }
+
+    [[nodiscard]] bool operator==(const DataPathKey& other) const noexcept {
+        return m_Hash == other.m_Hash && m_Utf8 == other.m_Utf8;
+    }
+
+private:
+    std::string m_Utf8;
+    std::uint64_t m_Hash = 0;
+};
+
+[[nodiscard]] inline std::size_t qHash(const DataPathKey& key, const std::size_t seed = 0) noexcept {
+    return static_cast<std::size_t>(key.hash()) ^ seed;
+}
+
+template <>
+struct std::hash<DataPathKey> {
+    std::size_t operator()(const DataPathKey& key) const noexcept {
+        return static_cast<std::size_t>(key.hash());
+    }
+};
+
+// Transparent hashing for maps keyed by folded UTF-8 paths, so DataPathKey lookups reuse its hash.
+struct DataPathHash {
+    using is_transparent = void;
+
+    std::size_t operator()(const std::string_view path) const noexcept {
+        return static_cast<std::size_t>(DataPathKey::hashUtf8(path));
+    }
+    std::size_t operator()(const DataPathKey& key) const noexcept {
+        return static_cast<std::size_t>(key.hash());
+    }
+};
+
+struct DataPathEqual {
+    using is_transparent = void;
+
+    bool operator()(const std::string_view left, const std::string_view right) const noexcept {
+        return left == right;
+    }
+    bool operator()(const std::string_view left, const DataPathKey& right) const noexcept {
+        return left == right.utf8();
+    }
+    bool operator()(const DataPathKey& left, const std::string_view right) const noexcept {
+        return left.utf8() == right;
+    }
+};
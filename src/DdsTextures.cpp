@@ -2,17 +2,19 @@
 
 #include <gli/load_dds.hpp>
 
-#include <QFile>
-
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <limits>
 
 namespace {
 
-constexpr std::size_t maxGliTextureLevels = 16;
+constexpr std::size_t maxGliTextureLevels = DdsImageView::MaxLevels;
+using LevelSizes = std::array<std::size_t, maxGliTextureLevels>;
+
+std::atomic<std::uint32_t> maxTextureDimension {0};
 
 using DdsHeader = gli::detail::dds_header;
 using DdsHeader10 = gli::detail::dds_header10;
@@ -137,6 +139,7 @@ bool ddsPayloadSize(
     const std::size_t depth,
     const std::size_t faces,
     const std::size_t levels,
+    LevelSizes& levelSizes,
     std::size_t& payloadSize
 ) {
     const auto blockSize = gli::block_size(format);
@@ -186,6 +189,7 @@ bool ddsPayloadSize(
             || !checkedAdd(payloadSize, levelBlocks, payloadSize)) {
             return false;
         }
+        levelSizes[level] = levelBlocks;
     }
 
     return checkedMul(payloadSize, faces, payloadSize);
@@ -234,13 +238,14 @@ DdsHeader emptyDdsHeader() {
 
 class DdsTextureReader {
 public:
-    DdsTextureReader(const char* data, const std::size_t size)
+    DdsTextureReader(const char* data, const std::size_t size, const std::uint32_t maxDimension)
         : m_Data(data)
         , m_Size(size)
+        , m_MaxDimension(maxDimension)
         , m_Header(emptyDdsHeader())
         , m_Header10(emptyDdsHeader10()) {}
 
-    gli::texture load() {
+    DdsImageView view() {
         if (!readHeader()) {
             return {};
         }
@@ -276,21 +281,68 @@ public:
         }
 
         const auto textureExtent = gli::texture::extent_type(m_Header.Width, m_Header.Height, depthCount);
-        if (!hasValidMipCount(textureExtent, mipMapCount)
-            || !hasValidPayload(format, depthCount, faceCount, mipMapCount)) {
+        if (!hasValidMipCount(textureExtent, mipMapCount)) {
             return {};
         }
 
-        gli::texture texture(target, format, textureExtent, layerCount, faceCount, mipMapCount);
-        if (!canCopyTexture(texture)) {
+        DdsImageView image;
+        std::size_t payloadSize = 0;
+        if (!ddsPayloadSize(
+                format,
+                m_Header.Width,
+                m_Header.Height,
+                depthCount,
+                faceCount,
+                mipMapCount,
+                image.levelSizes,
+                payloadSize
+            )
+            || payloadSize > m_Size - m_Offset) {
             return {};
         }
 
-        std::memcpy(texture.data(), m_Data + m_Offset, texture.size());
-        return texture;
+        // The payload stays in the source buffer; faces are stored one after another with all of their levels.
+        image.format = format;
+        image.target = target;
+        image.baseWidth = m_Header.Width;
+        image.baseHeight = m_Header.Height;
+        image.levels = mipMapCount;
+        image.faces = faceCount;
+        image.faceStride = payloadSize / faceCount;
+        for (std::size_t level = 1; level < mipMapCount; ++level) {
+            image.levelOffsets[level] = image.levelOffsets[level - 1] + image.levelSizes[level - 1];
+        }
+        image.payload = m_Data + m_Offset;
+        skipLevelsAboveMaxDimension(image);
+        return image;
     }
 
 private:
+    // Drops leading levels larger than the cap; the view then starts at the first kept level.
+    // Textures without a small enough level keep their smallest one.
+    void skipLevelsAboveMaxDimension(DdsImageView& image) const {
+        if (m_MaxDimension == 0) {
+            return;
+        }
+
+        std::size_t skipped = 0;
+        while (skipped + 1 < image.levels
+               && std::max(image.width(skipped), image.height(skipped)) > m_MaxDimension) {
+            ++skipped;
+        }
+        if (skipped == 0) {
+            return;
+        }
+
+        image.baseWidth = image.width(skipped);
+        image.baseHeight = image.height(skipped);
+        image.levels -= skipped;
+        for (std::size_t level = 0; level < image.levels; ++level) {
+            image.levelOffsets[level] = image.levelOffsets[level + skipped];
+            image.levelSizes[level] = image.levelSizes[level + skipped];
+        }
+    }
+
     bool readHeader() {
         if (!hasBaseHeader()) {
             return false;
@@ -402,43 +454,47 @@ private:
         return mipMapCount <= std::min<std::size_t>(gli::levels(textureExtent), maxGliTextureLevels);
     }
 
-    [[nodiscard]] bool hasValidPayload(
-        const gli::format format,
-        const std::size_t depthCount,
-        const std::size_t faceCount,
-        const std::size_t mipMapCount
-    ) const {
-        std::size_t payloadSize = 0;
-        return ddsPayloadSize(format, m_Header.Width, m_Header.Height, depthCount, faceCount, mipMapCount, payloadSize)
-               && payloadSize
-               <= m_Size
-               - m_Offset;
-    }
-
-    [[nodiscard]] bool canCopyTexture(const gli::texture& texture) const {
-        return !texture.empty() && texture.layers() == 1 && texture.size() <= m_Size - m_Offset;
-    }
-
     const char* m_Data = nullptr;
     std::size_t m_Size = 0;
     std::size_t m_Offset = 0;
+    std::uint32_t m_MaxDimension = 0;
     DdsHeader m_Header;
     DdsHeader10 m_Header10;
 };
 
 } // namespace
 
-gli::texture DdsTextures::loadIfValid(const char* data, const std::size_t size) {
-    DdsTextureReader reader(data, size);
-    return reader.load();
+void DdsTextures::setMaxDimension(const std::uint32_t maxDimension) {
+    maxTextureDimension.store(maxDimension);
+}
+
+DdsImageView DdsTextures::viewIfValid(const char* data, const std::size_t size) {
+    DdsTextureReader reader(data, size, maxTextureDimension.load());
+    return reader.view();
 }
 
-gli::texture DdsTextures::loadFileIfValid(const QString& path) {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) {
+std::size_t DdsTextures::viewedBytes(const DdsImageView& image) {
+    if (image.empty()) {
+        return 0;
+    }
+
+    const auto last = image.levels - 1;
+    return (image.levelOffsets[last] + image.levelSizes[last] - image.levelOffsets[0]) * image.faces;
+}
+
+DdsImageView DdsTextures::copyViewed(const DdsImageView& image, char* destination) {
+    if (image.empty()) {
         return {};
     }
 
-    const auto data = file.readAll();
-    return loadIfValid(data.constData(), static_cast<std::size_t>(data.size()));
+    auto copy = image;
+    copy.faceStride = viewedBytes(image) / image.faces;
+    copy.payload = destination;
+    for (std::size_t level = 0; level < image.levels; ++level) {
+        copy.levelOffsets[level] = image.levelOffsets[level] - image.levelOffsets[0];
+    }
+    for (std::size_t face = 0; face < image.faces; ++face) {
+        std::memcpy(destination + face * copy.faceStride, image.data(face, 0), copy.faceStride);
+    }
+    return copy;
 }
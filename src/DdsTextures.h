@@ -2,13 +2,55 @@
 
 #include <gli/gli.hpp>
 
-#include <QString>
-
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+
+// A validated DDS payload described in place. The viewed bytes are not owned and must
+// outlive the view; levels of one face are contiguous and faces follow each other.
+struct DdsImageView {
+    static constexpr std::size_t MaxLevels = 16;
+
+    gli::format format = gli::FORMAT_UNDEFINED;
+    gli::target target = gli::TARGET_2D;
+    std::uint32_t baseWidth = 0;
+    std::uint32_t baseHeight = 0;
+    std::size_t levels = 0;
+    std::size_t faces = 0;
+    std::size_t faceStride = 0;
+    std::array<std::size_t, MaxLevels> levelOffsets {};
+    std::array<std::size_t, MaxLevels> levelSizes {};
+    const char* payload = nullptr;
+
+    [[nodiscard]] bool empty() const noexcept {
+        return payload == nullptr || levels == 0 || faces == 0;
+    }
+    [[nodiscard]] std::uint32_t width(const std::size_t level) const noexcept {
+        return std::max<std::uint32_t>(baseWidth >> level, 1);
+    }
+    [[nodiscard]] std::uint32_t height(const std::size_t level) const noexcept {
+        return std::max<std::uint32_t>(baseHeight >> level, 1);
+    }
+    [[nodiscard]] std::size_t size(const std::size_t level) const noexcept {
+        return levelSizes[level];
+    }
+    [[nodiscard]] const char* data(const std::size_t face, const std::size_t level) const noexcept {
+        return payload + face * faceStride + levelOffsets[level];
+    }
+};
 
 namespace DdsTextures {
 
-[[nodiscard]] gli::texture loadIfValid(const char* data, std::size_t size);
-[[nodiscard]] gli::texture loadFileIfValid(const QString& path);
+// Views only describe levels whose width and height fit maxDimension; zero keeps every level.
+void setMaxDimension(std::uint32_t maxDimension);
+
+[[nodiscard]] DdsImageView viewIfValid(const char* data, std::size_t size);
+
+// Bytes of the levels a view describes, over all of its faces.
+[[nodiscard]] std::size_t viewedBytes(const DdsImageView& image);
+// Copies only the viewed levels to destination, which must hold viewedBytes(image), and
+// returns a view of the copy.
+[[nodiscard]] DdsImageView copyViewed(const DdsImageView& image, char* destination);
 
 } // namespace DdsTextures
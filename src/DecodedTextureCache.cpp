@@ -0,0 +1,123 @@
+#include "DecodedTextureCache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+QString fileKey(const QString& path) {
+    const QFileInfo fileInfo(path);
+    if (path.isEmpty() || !fileInfo.isFile()) {
+        return {};
+    }
+
+    return QStringLiteral("%1|%2|%3")
+        .arg(QDir::fromNativeSeparators(fileInfo.absoluteFilePath()).toLower())
+        .arg(fileInfo.size())
+        .arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+} // namespace
+
+DecodedTextureCache& DecodedTextureCache::instance() {
+    static DecodedTextureCache cache;
+    return cache;
+}
+
+QString DecodedTextureCache::sourceKey(const TextureLoader::Location& location) {
+    if (!location.loosePath.isEmpty()) {
+        return fileKey(location.loosePath);
+    }
+    if (!location.archiveRead) {
+        return {};
+    }
+
+    const auto archiveKey = fileKey(location.archiveRead->archivePath);
+    if (archiveKey.isEmpty()) {
+        return {};
+    }
+    return archiveKey + QLatin1Char('|') + location.archiveRead->dataPath.toLower();
+}
+
+std::optional<DecodedTexture> DecodedTextureCache::find(const QString& sourceKey) {
+    const std::scoped_lock lock(m_Mutex);
+    const auto it = m_Lookup.constFind(sourceKey);
+    if (sourceKey.isEmpty() || it == m_Lookup.cend()) {
+        ++m_Stats.misses;
+        return std::nullopt;
+    }
+
+    ++m_Stats.hits;
+    const auto entry = it.value();
+    m_Entries.splice(m_Entries.begin(), m_Entries, entry);
+    return entry->texture;
+}
+
+bool DecodedTextureCache::fitsBudget(const std::size_t bytes) const {
+    const std::scoped_lock lock(m_Mutex);
+    return bytes <= m_MemoryBudget;
+}
+
+void DecodedTextureCache::insert(const QString& sourceKey, const DecodedTexture& texture) {
+    if (sourceKey.isEmpty() || texture.image.empty()) {
+        return;
+    }
+
+    const std::scoped_lock lock(m_Mutex);
+    if (texture.bytes.size() > m_MemoryBudget) {
+        return;
+    }
+    if (const auto it = m_Lookup.constFind(sourceKey); it != m_Lookup.cend()) {
+        erase(it.value());
+    }
+
+    m_Entries.push_front({.key = sourceKey, .texture = texture});
+    m_Lookup.insert(sourceKey, m_Entries.begin());
+    m_Bytes += texture.bytes.size();
+    evictOverBudget();
+}
+
+void DecodedTextureCache::setMemoryBudget(const std::size_t bytes) {
+    const std::scoped_lock lock(m_Mutex);
+    m_MemoryBudget = bytes;
+    evictOverBudget();
+}
+
+void DecodedTextureCache::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    qDebug(
+        "Clearing decoded texture cache: %llu hits, %llu misses, %llu evictions",
+        static_cast<unsigned long long>(m_Stats.hits),
+        static_cast<unsigned long long>(m_Stats.misses),
+        static_cast<unsigned long long>(m_Stats.evictions)
+    );
+
+    m_Entries.clear();
+    m_Lookup.clear();
+    m_Bytes = 0;
+}
+
+DecodedTextureCacheStats DecodedTextureCache::stats() const {
+    const std::scoped_lock lock(m_Mutex);
+    auto stats = m_Stats;
+    stats.textureCount = static_cast<std::size_t>(m_Lookup.size());
+    stats.bytes = m_Bytes;
+    return stats;
+}
+
+void DecodedTextureCache::evictOverBudget() {
+    while (m_Bytes > m_MemoryBudget && !m_Entries.empty()) {
+        ++m_Stats.evictions;
+        erase(std::prev(m_Entries.end()));
+    }
+}
+
+void DecodedTextureCache::erase(const EntryList::iterator it) {
+    m_Bytes -= std::min(m_Bytes, it->texture.bytes.size());
+    m_Lookup.remove(it->key);
+    m_Entries.erase(it);
+}
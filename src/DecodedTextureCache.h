@@ -0,0 +1,60 @@
+#pragma once
+
+#include "TextureLoader.h"
+
+#include <QHash>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+
+struct DecodedTextureCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t textureCount = 0;
+    std::size_t bytes = 0;
+};
+
+// Process-wide LRU of validated DDS bytes, so a new OpenGL context only pays for the upload.
+// Keys name the loose file or archive record together with its file's size and modification
+// time; entries of changed files are never hit again and age out.
+class DecodedTextureCache final {
+public:
+    static constexpr std::size_t DefaultMemoryBudget = std::size_t {256} * 1024 * 1024;
+
+    static DecodedTextureCache& instance();
+
+    // Stats the source file; returns an empty key when it does not exist.
+    [[nodiscard]] static QString sourceKey(const TextureLoader::Location& location);
+
+    [[nodiscard]] std::optional<DecodedTexture> find(const QString& sourceKey);
+    [[nodiscard]] bool fitsBudget(std::size_t bytes) const;
+    void insert(const QString& sourceKey, const DecodedTexture& texture);
+    void setMemoryBudget(std::size_t bytes);
+    void clear();
+    [[nodiscard]] DecodedTextureCacheStats stats() const;
+
+private:
+    struct Entry {
+        QString key;
+        DecodedTexture texture;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    DecodedTextureCache() = default;
+
+    void evictOverBudget();
+    void erase(EntryList::iterator it);
+
+    mutable std::mutex m_Mutex;
+    EntryList m_Entries;
+    QHash<QString, EntryList::iterator> m_Lookup;
+    std::size_t m_MemoryBudget = DefaultMemoryBudget;
+    std::size_t m_Bytes = 0;
+    DecodedTextureCacheStats m_Stats;
+};
@@ -0,0 +1,104 @@
+#include "DirectorySnapshots.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include <utility>
+
+namespace {
+// Keeps memory bounded when browsing many meshes across deep texture trees.
+constexpr qsizetype MaxSnapshots = 4096;
+
+qint64 directoryStamp(const QString& directory) {
+    const QFileInfo directoryInfo(directory);
+    return directoryInfo.isDir() ? directoryInfo.lastModified().toMSecsSinceEpoch() : -1;
+}
+} // namespace
+
+DirectorySnapshots& DirectorySnapshots::instance() {
+    static DirectorySnapshots snapshots;
+    return snapshots;
+}
+
+bool DirectorySnapshots::isFile(const QString& path) {
+    return find(path) == Entry::File;
+}
+
+bool DirectorySnapshots::exists(const QString& path) {
+    return find(path) != Entry::Missing;
+}
+
+void DirectorySnapshots::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    m_Snapshots.clear();
+}
+
+DirectorySnapshots::Entry DirectorySnapshots::find(const QString& path) {
+    const auto cleanPath = QDir::cleanPath(QDir::fromNativeSeparators(path));
+    const auto separator = cleanPath.lastIndexOf('/');
+    if (path.isEmpty() || !QDir::isAbsolutePath(cleanPath) || separator < 0 || separator + 1 == cleanPath.size()) {
+        const QFileInfo fileInfo(cleanPath);
+        if (!fileInfo.exists()) {
+            return Entry::Missing;
+        }
+        return fileInfo.isDir() ? Entry::Directory : Entry::File;
+    }
+
+    // Keep the slash of root directories such as "C:/".
+    const auto directory = cleanPath.left(separator == cleanPath.indexOf('/') ? separator + 1 : separator);
+    const auto key = directory.toLower();
+    const auto name = cleanPath.mid(separator + 1).toLower();
+    const auto now = std::chrono::steady_clock::now();
+    {
+        const std::scoped_lock lock(m_Mutex);
+        if (const auto it = m_Snapshots.constFind(key);
+            it != m_Snapshots.cend() && now - it->checkedAt < RevalidateInterval) {
+            return entryIn(it.value(), name);
+        }
+    }
+
+    // Stat and list unlocked, so isFile() checks on the GUI thread do not wait behind a
+    // worker listing a large texture folder.
+    const auto modified = directoryStamp(directory);
+    {
+        const std::scoped_lock lock(m_Mutex);
+        if (const auto it = m_Snapshots.find(key); it != m_Snapshots.end() && it->modified == modified) {
+            it->checkedAt = now;
+            return entryIn(it.value(), name);
+        }
+    }
+
+    auto snapshot = listDirectory(directory, modified, now);
+    const std::scoped_lock lock(m_Mutex);
+    if (!m_Snapshots.contains(key) && m_Snapshots.size() >= MaxSnapshots) {
+        m_Snapshots.clear();
+    }
+    return entryIn(m_Snapshots.insert(key, std::move(snapshot)).value(), name);
+}
+
+DirectorySnapshots::Entry DirectorySnapshots::entryIn(const Snapshot& snapshot, const QString& name) {
+    const auto it = snapshot.entries.constFind(name);
+    if (it == snapshot.entries.cend()) {
+        return Entry::Missing;
+    }
+    return it.value() ? Entry::Directory : Entry::File;
+}
+
+DirectorySnapshots::Snapshot DirectorySnapshots::listDirectory(
+    const QString& directory,
+    const qint64 modified,
+    const std::chrono::steady_clock::time_point now
+) {
+    Snapshot snapshot {.modified = modified, .checkedAt = now, .entries = {}};
+    if (snapshot.modified >= 0) {
+        const auto entries = QDir(directory).entryInfoList(
+            QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System
+        );
+        snapshot.entries.reserve(entries.size());
+        for (const auto& entry : entries) {
+            snapshot.entries.insert(entry.fileName().toLower(), entry.isDir());
+        }
+    }
+    return snapshot;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <chrono>
+#include <mutex>
+
+// Process-wide listings of loose-file folders, so existence checks for mod and game Data
+// files are answered from memory instead of one filesystem query each. A folder is listed
+// once and relisted only when its modification time changes, which is checked at most
+// every RevalidateInterval. MO2 refreshes and mod list changes clear every listing.
+class DirectorySnapshots final {
+public:
+    static constexpr std::chrono::seconds RevalidateInterval {2};
+
+    static DirectorySnapshots& instance();
+
+    // Paths are absolute; lookups ignore case like the Windows filesystems MO2 runs on.
+    [[nodiscard]] bool isFile(const QString& path);
+    [[nodiscard]] bool exists(const QString& path);
+    void clear();
+
+private:
+    struct Snapshot {
+        qint64 modified = -1;
+        std::chrono::steady_clock::time_point checkedAt;
+        // Lowercased entry names mapped to whether they are directories.
+        QHash<QString, bool> entries;
+    };
+
+    enum class Entry {
+        Missing,
+        File,
+        Directory
+    };
+
+    DirectorySnapshots() = default;
+
+    [[nodiscard]] Entry find(const QString& path);
+    [[nodiscard]] static Entry entryIn(const Snapshot& snapshot, const QString& name);
+    [[nodiscard]] static Snapshot listDirectory(
+        const QString& directory,
+        qint64 modified,
+        std::chrono::steady_clock::time_point now
+    );
+
+    std::mutex m_Mutex;
+    QHash<QString, Snapshot> m_Snapshots;
+};
@@ -4,54 +4,300 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
 
 namespace {
 constexpr std::array<char, 4> BGSM = {'B', 'G', 'S', 'M'};
 constexpr std::array<char, 4> BGEM = {'B', 'G', 'E', 'M'};
-constexpr qsizetype TextureListOffset = 63;
 constexpr qsizetype ShaderMaterialTextureCount = 9;
 constexpr qsizetype EffectMaterialTextureCount = 5;
+// Version 3 dropped the environment, inner layer and displacement textures and added
+// specular, lighting and flow maps the preview does not use (-1).
+constexpr std::array<int, 9> ShaderMaterialV3TextureIndices = {
+    Fo4Material::Diffuse,
+    Fo4Material::Normal,
+    Fo4Material::Specular,
+    Fo4Material::Greyscale,
+    Fo4Material::GlowOrEnvironmentMask,
+    7,
+    -1,
+    -1,
+    -1,
+};
 
-[[nodiscard]] bool startsWithMagic(const QByteArray& data, const std::array<char, 4>& magic) {
-    return data.size()
-           >= static_cast<qsizetype>(magic.size())
-           && std::equal(magic.begin(), magic.end(), data.constData());
+[[nodiscard]] bool startsWithMagic(const std::span<const char> data, const std::array<char, 4>& magic) {
+    return data.size() >= magic.size() && std::equal(magic.begin(), magic.end(), data.begin());
 }
 
-[[nodiscard]] std::uint32_t readUint32LE(const QByteArray& data, const qsizetype offset) {
-    const auto* const bytes = reinterpret_cast<const unsigned char*>(data.constData() + offset);
+[[nodiscard]] std::uint32_t readUint32LE(const std::span<const char> data, const std::size_t offset) {
+    const auto* const bytes = reinterpret_cast<const unsigned char*>(data.data() + offset);
     return static_cast<std::uint32_t>(bytes[0])
            | (static_cast<std::uint32_t>(bytes[1]) << 8)
            | (static_cast<std::uint32_t>(bytes[2]) << 16)
            | (static_cast<std::uint32_t>(bytes[3]) << 24);
 }
 
-[[nodiscard]] bool readBethesdaString(const QByteArray& data, qsizetype& offset, QString& value) {
-    if (offset < 0 || offset + 4 > data.size()) {
-        return false;
+// Reads little-endian fields in file order. A read past the end fails every later read, so
+// callers check ok() once after a group of fields.
+class MaterialReader {
+public:
+    explicit MaterialReader(const std::span<const char> data)
+        : m_Data {data} {}
+
+    [[nodiscard]] bool ok() const noexcept {
+        return m_Ok;
+    }
+
+    void skip(const std::size_t size) {
+        static_cast<void>(take(size));
+    }
+
+    std::uint8_t readByte() {
+        const auto* const bytes = take(1);
+        return bytes ? static_cast<std::uint8_t>(*bytes) : 0;
+    }
+
+    bool readBool() {
+        return readByte() != 0;
+    }
+
+    std::uint32_t readUint32() {
+        return take(4) ? readUint32LE(m_Data, m_Offset - 4) : 0;
     }
 
-    const auto length = readUint32LE(data, offset);
-    offset += 4;
-    if (length == 0) {
-        value.clear();
-        return true;
+    float readFloat() {
+        return std::bit_cast<float>(readUint32());
     }
 
-    if (std::cmp_greater(length, data.size() - offset)) {
-        return false;
+    std::array<float, 3> readColor() {
+        return {readFloat(), readFloat(), readFloat()};
     }
 
-    auto bytes = QByteArray(data.constData() + offset, static_cast<qsizetype>(length));
-    offset += static_cast<qsizetype>(length);
-    if (bytes.endsWith('\0')) {
-        bytes.chop(1);
+    QString readString() {
+        const auto length = readUint32();
+        const auto* const chars = take(length);
+        if (!chars || length == 0) {
+            return {};
+        }
+
+        auto bytes = std::span(chars, length);
+        if (bytes.back() == '\0') {
+            bytes = bytes.first(bytes.size() - 1);
+        }
+
+        const auto text = QString::fromUtf8(bytes.data(), static_cast<qsizetype>(bytes.size()));
+        return QDir::fromNativeSeparators(text).trimmed();
+    }
+
+private:
+    [[nodiscard]] const char* take(const std::size_t size) {
+        if (!m_Ok || size > m_Data.size() - m_Offset) {
+            m_Ok = false;
+            return nullptr;
+        }
+
+        const auto* const bytes = m_Data.data() + m_Offset;
+        m_Offset += size;
+        return bytes;
     }
 
-    value = QDir::fromNativeSeparators(QString::fromUtf8(bytes)).trimmed();
-    return true;
+    std::span<const char> m_Data;
+    std::size_t m_Offset = 0;
+    bool m_Ok = true;
+};
+
+void setFlag(Fo4Material::Parameters& parameters, const Fo4Material::Flag flag, const bool enabled) {
+    parameters.flags = enabled ? parameters.flags | flag : parameters.flags & ~flag;
+}
+
+// The Creation Kit only writes these source/destination factor pairs (NiAlphaProperty numbering).
+Fo4Material::AlphaBlendMode alphaBlendMode(const bool enabled, const std::uint32_t source, const std::uint32_t dest) {
+    if (!enabled) {
+        return Fo4Material::AlphaBlendMode::None;
+    }
+    if (source == 6 && dest == 0) {
+        return Fo4Material::AlphaBlendMode::Additive;
+    }
+    if (source == 4 && dest == 1) {
+        return Fo4Material::AlphaBlendMode::Multiplicative;
+    }
+    return Fo4Material::AlphaBlendMode::Standard;
+}
+
+void readHeader(MaterialReader& reader, Fo4Material::Parameters& parameters) {
+    parameters.version = reader.readUint32();
+    const auto version = parameters.version;
+    const auto tileFlags = reader.readUint32();
+    setFlag(parameters, Fo4Material::TileU, tileFlags & 2);
+    setFlag(parameters, Fo4Material::TileV, tileFlags & 1);
+    parameters.uvOffset = {reader.readFloat(), reader.readFloat()};
+    parameters.uvScale = {reader.readFloat(), reader.readFloat()};
+    parameters.alpha = reader.readFloat();
+    const auto blendEnabled = reader.readBool();
+    const auto blendSource = reader.readUint32();
+    const auto blendDest = reader.readUint32();
+    parameters.alphaBlendMode = alphaBlendMode(blendEnabled, blendSource, blendDest);
+    parameters.alphaTestRef = static_cast<float>(reader.readByte()) / 255.0f;
+    setFlag(parameters, Fo4Material::AlphaTest, reader.readBool());
+    setFlag(parameters, Fo4Material::ZBufferWrite, reader.readBool());
+    setFlag(parameters, Fo4Material::ZBufferTest, reader.readBool());
+    // Screen-space reflections and their wetness control.
+    reader.skip(2);
+    setFlag(parameters, Fo4Material::Decal, reader.readBool());
+    setFlag(parameters, Fo4Material::TwoSided, reader.readBool());
+    // Decal no-fade and non-occluder.
+    reader.skip(2);
+    setFlag(parameters, Fo4Material::Refraction, reader.readBool());
+    // Refraction falloff.
+    reader.skip(1);
+    parameters.refractionPower = reader.readFloat();
+    if (version < 10) {
+        setFlag(parameters, Fo4Material::EnvironmentMapping, reader.readBool());
+        parameters.environmentMapScale = reader.readFloat();
+    } else {
+        // Depth bias.
+        reader.skip(1);
+    }
+    setFlag(parameters, Fo4Material::GreyscaleToPaletteColor, reader.readBool());
+    if (version >= 6) {
+        // Mask writes.
+        reader.skip(1);
+    }
+}
+
+void readShaderMaterialTextures(MaterialReader& reader, Fo4Material::Material& material) {
+    if (material.parameters.version <= 2) {
+        for (qsizetype i = 0; i < ShaderMaterialTextureCount; ++i) {
+            material.textures.push_back(reader.readString());
+        }
+        return;
+    }
+
+    material.textures.resize(ShaderMaterialTextureCount);
+    for (const auto index : ShaderMaterialV3TextureIndices) {
+        auto texturePath = reader.readString();
+        if (index >= 0) {
+            material.textures[index] = std::move(texturePath);
+        }
+    }
+    if (material.parameters.version >= 17) {
+        // Distance field alpha.
+        static_cast<void>(reader.readString());
+    }
+}
+
+void readShaderMaterialParameters(MaterialReader& reader, Fo4Material::Parameters& parameters) {
+    const auto version = parameters.version;
+    // Editor alpha reference.
+    reader.skip(1);
+    if (version >= 8) {
+        // Translucency flags, subsurface color, transmissive scale and turbulence.
+        reader.skip(3 + 12 + 4 + 4);
+    } else {
+        setFlag(parameters, Fo4Material::RimLighting, reader.readBool());
+        parameters.rimPower = reader.readFloat();
+        parameters.backLightPower = reader.readFloat();
+        setFlag(parameters, Fo4Material::SubsurfaceLighting, reader.readBool());
+        parameters.subsurfaceRolloff = reader.readFloat();
+    }
+
+    setFlag(parameters, Fo4Material::SpecularEnabled, reader.readBool());
+    parameters.specularColor = reader.readColor();
+    parameters.specularMult = reader.readFloat();
+    parameters.smoothness = reader.readFloat();
+    parameters.fresnelPower = reader.readFloat();
+    // Wetness control values; version 10 dropped the environment map scale.
+    reader.skip(version < 10 ? 6 * 4 : 5 * 4);
+    if (version > 2) {
+        setFlag(parameters, Fo4Material::Pbr, reader.readBool());
+        if (version >= 9) {
+            // Custom porosity and its value.
+            reader.skip(1 + 4);
+        }
+    }
+
+    // Root material path and anisotropic lighting.
+    static_cast<void>(reader.readString());
+    reader.skip(1);
+    setFlag(parameters, Fo4Material::Emit, reader.readBool());
+    if (parameters.has(Fo4Material::Emit)) {
+        parameters.emittanceColor = reader.readColor();
+    }
+    parameters.emittanceMult = reader.readFloat();
+    setFlag(parameters, Fo4Material::ModelSpaceNormals, reader.readBool());
+    // External emittance, luminous emittance and adaptive emissive exposure.
+    reader.skip(1);
+    if (version >= 12) {
+        reader.skip(4);
+    }
+    if (version >= 13) {
+        reader.skip(1 + 3 * 4);
+    }
+    if (version < 8) {
+        setFlag(parameters, Fo4Material::BackLighting, reader.readBool());
+    }
+    // Receive shadows, hide secret, cast shadows, dissolve fade and assume shadowmask.
+    reader.skip(5);
+    setFlag(parameters, Fo4Material::Glowmap, reader.readBool());
+    if (version < 7) {
+        // Window and eye environment mapping.
+        reader.skip(2);
+    }
+    setFlag(parameters, Fo4Material::HairTint, reader.readBool());
+    parameters.hairTintColor = reader.readColor();
+    // Tree, facegen, skin tint and tessellation, plus tessellation values before version 3.
+    reader.skip(4);
+    if (version < 3) {
+        reader.skip(5 * 4);
+    }
+    parameters.grayscaleToPaletteScale = reader.readFloat();
+    if (version >= 1) {
+        // Skew specular alpha.
+        reader.skip(1);
+    }
+}
+
+void readEffectMaterialTextures(MaterialReader& reader, Fo4Material::Material& material) {
+    // Base, greyscale, environment, normal and environment mask, then specular, lighting and glow.
+    const auto textureCount = material.parameters.version >= 11 ? EffectMaterialTextureCount + 3
+                                                                : EffectMaterialTextureCount;
+    for (qsizetype i = 0; i < textureCount; ++i) {
+        material.textures.push_back(reader.readString());
+    }
+}
+
+void readEffectMaterialParameters(MaterialReader& reader, Fo4Material::Parameters& parameters) {
+    const auto version = parameters.version;
+    if (version >= 10) {
+        setFlag(parameters, Fo4Material::EnvironmentMapping, reader.readBool());
+        parameters.environmentMapScale = reader.readFloat();
+    }
+    setFlag(parameters, Fo4Material::Blood, reader.readBool());
+    setFlag(parameters, Fo4Material::EffectLighting, reader.readBool());
+    setFlag(parameters, Fo4Material::Falloff, reader.readBool());
+    setFlag(parameters, Fo4Material::FalloffColor, reader.readBool());
+    setFlag(parameters, Fo4Material::GreyscaleToPaletteAlpha, reader.readBool());
+    setFlag(parameters, Fo4Material::SoftEffect, reader.readBool());
+    parameters.baseColor = reader.readColor();
+    parameters.baseColorScale = reader.readFloat();
+    parameters.falloffParams = {reader.readFloat(), reader.readFloat(), reader.readFloat(), reader.readFloat()};
+    parameters.lightingInfluence = reader.readFloat();
+    // Environment map minimum LOD.
+    reader.skip(1);
+    parameters.softDepth = reader.readFloat();
+    if (version >= 11) {
+        parameters.emittanceColor = reader.readColor();
+    }
+    if (version >= 15) {
+        // Adaptive emissive exposure.
+        reader.skip(3 * 4);
+    }
+    if (version >= 16) {
+        setFlag(parameters, Fo4Material::Glowmap, reader.readBool());
+    }
 }
 } // namespace
 
@@ -74,32 +320,33 @@ QString normalizeMaterialDataPath(QString path) {
     return path;
 }
 
-Material read(const QByteArray& data) {
-    const qsizetype textureCount = [&] {
-        if (startsWithMagic(data, BGSM)) {
-            return ShaderMaterialTextureCount;
-        }
-        if (startsWithMagic(data, BGEM)) {
-            return EffectMaterialTextureCount;
-        }
-        return qsizetype {0};
-    }();
-
-    if (textureCount == 0 || data.size() < TextureListOffset) {
+Material read(const std::span<const char> data) {
+    const auto effect = startsWithMagic(data, BGEM);
+    if (!effect && !startsWithMagic(data, BGSM)) {
         return {};
     }
 
     Material material;
-    qsizetype offset = TextureListOffset;
-    for (qsizetype i = 0; i < textureCount; ++i) {
-        QString texturePath;
-        if (!readBethesdaString(data, offset, texturePath)) {
-            return {};
-        }
-        material.textures.push_back(texturePath);
+    material.effect = effect;
+    MaterialReader reader(data);
+    reader.skip(BGSM.size());
+    readHeader(reader, material.parameters);
+    if (effect) {
+        readEffectMaterialTextures(reader, material);
+    } else {
+        readShaderMaterialTextures(reader, material);
+    }
+    if (!reader.ok()) {
+        return {};
     }
 
     material.valid = true;
+    if (effect) {
+        readEffectMaterialParameters(reader, material.parameters);
+    } else {
+        readShaderMaterialParameters(reader, material.parameters);
+    }
+    material.hasParameters = reader.ok();
     return material;
 }
 
@@ -1,11 +1,16 @@
 #pragma once
 
-#include <QByteArray>
 #include <QString>
 #include <QStringList>
 
+#include <array>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
 namespace Fo4Material {
 
+// Texture list indices in the version 2 BGSM layout; other versions are mapped onto it.
 enum TextureIndex {
     Diffuse = 0,
     Normal = 1,
@@ -15,12 +20,93 @@ enum TextureIndex {
     GlowOrEnvironmentMask = 5,
 };
 
+enum Flag : std::uint32_t {
+    TileU = 1U << 0,
+    TileV = 1U << 1,
+    AlphaTest = 1U << 2,
+    ZBufferWrite = 1U << 3,
+    ZBufferTest = 1U << 4,
+    TwoSided = 1U << 5,
+    Decal = 1U << 6,
+    Refraction = 1U << 7,
+    EnvironmentMapping = 1U << 8,
+    GreyscaleToPaletteColor = 1U << 9,
+    GreyscaleToPaletteAlpha = 1U << 10,
+    SpecularEnabled = 1U << 11,
+    Emit = 1U << 12,
+    Glowmap = 1U << 13,
+    RimLighting = 1U << 14,
+    BackLighting = 1U << 15,
+    SubsurfaceLighting = 1U << 16,
+    HairTint = 1U << 17,
+    ModelSpaceNormals = 1U << 18,
+    Pbr = 1U << 19,
+    Falloff = 1U << 20,
+    FalloffColor = 1U << 21,
+    EffectLighting = 1U << 22,
+    Blood = 1U << 23,
+    SoftEffect = 1U << 24,
+};
+
+enum class AlphaBlendMode : std::uint32_t {
+    None,
+    Standard,
+    Additive,
+    Multiplicative,
+};
+
+// Everything the renderer takes from a BGSM or BGEM besides texture paths, decoded in one pass.
+// Fields a material version does not store keep these defaults.
+struct Parameters {
+    std::uint32_t version = 0;
+    std::uint32_t flags = ZBufferWrite | ZBufferTest;
+    AlphaBlendMode alphaBlendMode = AlphaBlendMode::None;
+    float alpha = 1.0f;
+    // Normalized to 0-1 like NiAlphaProperty thresholds.
+    float alphaTestRef = 0.5f;
+    std::array<float, 2> uvOffset {0.0f, 0.0f};
+    std::array<float, 2> uvScale {1.0f, 1.0f};
+    float refractionPower = 0.0f;
+    float environmentMapScale = 1.0f;
+    float grayscaleToPaletteScale = 1.0f;
+
+    // BGSM only.
+    std::array<float, 3> specularColor {1.0f, 1.0f, 1.0f};
+    float specularMult = 1.0f;
+    float smoothness = 1.0f;
+    float fresnelPower = 5.0f;
+    float rimPower = 2.0f;
+    float backLightPower = 0.0f;
+    float subsurfaceRolloff = 0.3f;
+    std::array<float, 3> emittanceColor {1.0f, 1.0f, 1.0f};
+    float emittanceMult = 1.0f;
+    std::array<float, 3> hairTintColor {1.0f, 1.0f, 1.0f};
+
+    // BGEM only.
+    std::array<float, 3> baseColor {1.0f, 1.0f, 1.0f};
+    float baseColorScale = 1.0f;
+    // Start angle, stop angle, start opacity and stop opacity.
+    std::array<float, 4> falloffParams {1.0f, 1.0f, 1.0f, 1.0f};
+    float lightingInfluence = 1.0f;
+    float softDepth = 100.0f;
+
+    [[nodiscard]] bool has(const Flag flag) const noexcept {
+        return (flags & flag) != 0;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Parameters> && std::is_standard_layout_v<Parameters>);
+
 struct Material {
     QStringList textures;
+    Parameters parameters;
+    bool effect = false;
     bool valid = false;
+    // False when the texture list parsed but a later field did not, e.g. for an unknown version.
+    bool hasParameters = false;
 };
 
 [[nodiscard]] QString normalizeMaterialDataPath(QString path);
-[[nodiscard]] Material read(const QByteArray& data);
+[[nodiscard]] Material read(std::span<const char> data);
 
 }
@@ -0,0 +1,45 @@
+#include "Fo4MaterialCache.h"
+#include "DataPathKey.h"
+
+#include <utility>
+
+namespace {
+// Materials are a few hundred bytes; the cap only guards against unbounded growth.
+constexpr qsizetype MaxMaterials = 16384;
+}
+
+Fo4MaterialCache& Fo4MaterialCache::instance() {
+    static Fo4MaterialCache materialCache;
+    return materialCache;
+}
+
+std::optional<Fo4Material::Material> Fo4MaterialCache::find(
+    const QString& sourceKey,
+    const QString& materialPath
+) const {
+    const auto materialKey = key(sourceKey, materialPath);
+    const std::scoped_lock lock(m_Mutex);
+    const auto it = m_Materials.constFind(materialKey);
+    if (it == m_Materials.cend()) {
+        return std::nullopt;
+    }
+    return it.value();
+}
+
+void Fo4MaterialCache::insert(const QString& sourceKey, const QString& materialPath, Fo4Material::Material material) {
+    auto materialKey = key(sourceKey, materialPath);
+    const std::scoped_lock lock(m_Mutex);
+    if (m_Materials.size() >= MaxMaterials && !m_Materials.contains(materialKey)) {
+        m_Materials.clear();
+    }
+    m_Materials.insert(std::move(materialKey), std::move(material));
+}
+
+void Fo4MaterialCache::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    m_Materials.clear();
+}
+
+QString Fo4MaterialCache::key(const QString& sourceKey, const QString& materialPath) {
+    return DataPathKey::fold(sourceKey + materialPath);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Fo4Material.h"
+
+#include <QHash>
+#include <QString>
+
+#include <mutex>
+#include <optional>
+
+// Process-wide parsed BGSM/BGEM files, shared by the texture source resolver and the
+// renderer so a material used by many shapes is read and parsed once. Unreadable or
+// invalid materials are kept too, so they are not searched for again. MO2 mod list,
+// plugin and profile changes clear it.
+class Fo4MaterialCache final {
+public:
+    static Fo4MaterialCache& instance();
+
+    // sourceKey is textureProviderKey() of the texture source that read the material.
+    [[nodiscard]] std::optional<Fo4Material::Material> find(
+        const QString& sourceKey,
+        const QString& materialPath
+    ) const;
+    void insert(const QString& sourceKey, const QString& materialPath, Fo4Material::Material material);
+    void clear();
+
+private:
+    Fo4MaterialCache() = default;
+
+    // Folded like DataPathKey, so lookups ignore case and separators.
+    [[nodiscard]] static QString key(const QString& sourceKey, const QString& materialPath);
+
+    mutable std::mutex m_Mutex;
+    QHash<QString, Fo4Material::Material> m_Materials;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <utility>
+
+struct LruCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t fileCount = 0;
+    std::size_t bytes = 0;
+};
+
+// String-keyed LRU bounded by the byte sizes its callers report. Not synchronized; the
+// process-wide caches built on it guard it with their own mutex.
+template <typename Value>
+class LruCache final {
+public:
+    explicit LruCache(const std::size_t memoryBudget) : m_MemoryBudget(memoryBudget) {}
+
+    // Counts a hit or miss and moves a hit to the front.
+    [[nodiscard]] Value* find(const QString& key) {
+        const auto it = m_Lookup.constFind(key);
+        if (key.isEmpty() || it == m_Lookup.cend()) {
+            ++m_Stats.misses;
+            return nullptr;
+        }
+
+        ++m_Stats.hits;
+        const auto entry = it.value();
+        m_Entries.splice(m_Entries.begin(), m_Entries, entry);
+        return &entry->value;
+    }
+
+    // Looks an entry up without touching the stats or the eviction order.
+    [[nodiscard]] Value* peek(const QString& key) {
+        const auto it = m_Lookup.constFind(key);
+        return it == m_Lookup.cend() ? nullptr : &it.value()->value;
+    }
+    [[nodiscard]] const Value* peek(const QString& key) const {
+        const auto it = m_Lookup.constFind(key);
+        return it == m_Lookup.cend() ? nullptr : &it.value()->value;
+    }
+
+    // Ignores empty keys and values larger than the whole budget.
+    void insert(const QString& key, Value value, const std::size_t bytes) {
+        if (key.isEmpty() || bytes > m_MemoryBudget) {
+            return;
+        }
+
+        if (const auto it = m_Lookup.constFind(key); it != m_Lookup.cend()) {
+            erase(it.value());
+        }
+
+        m_Entries.push_front({.key = key, .value = std::move(value), .bytes = bytes});
+        m_Lookup.insert(key, m_Entries.begin());
+        m_Bytes += bytes;
+        while (m_Bytes > m_MemoryBudget && !m_Entries.empty()) {
+            ++m_Stats.evictions;
+            erase(std::prev(m_Entries.end()));
+        }
+    }
+
+    void clear() {
+        m_Entries.clear();
+        m_Lookup.clear();
+        m_Bytes = 0;
+    }
+
+    [[nodiscard]] LruCacheStats stats() const {
+        auto stats = m_Stats;
+        stats.fileCount = static_cast<std::size_t>(m_Lookup.size());
+        stats.bytes = m_Bytes;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        QString key;
+        Value value;
+        std::size_t bytes = 0;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void erase(const typename EntryList::iterator it) {
+        m_Bytes -= std::min(m_Bytes, it->bytes);
+        m_Lookup.remove(it->key);
+        m_Entries.erase(it);
+    }
+
+    std::size_t m_MemoryBudget;
+    EntryList m_Entries;
+    QHash<QString, typename EntryList::iterator> m_Lookup;
+    std::size_t m_Bytes = 0;
+    LruCacheStats m_Stats;
+};
@@ -0,0 +1,227 @@
+#include "Lz4Frame.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr std::uint32_t FrameMagic = 0x184D2204;
+constexpr std::uint32_t SkippableMagicMask = 0xFFFFFFF0;
+constexpr std::uint32_t SkippableMagic = 0x184D2A50;
+constexpr std::uint32_t UncompressedBlockFlag = 0x80000000;
+constexpr std::size_t MinMatchLength = 4;
+
+constexpr std::uint8_t BlockChecksumFlag = 0x10;
+constexpr std::uint8_t ContentSizeFlag = 0x08;
+constexpr std::uint8_t ContentChecksumFlag = 0x04;
+constexpr std::uint8_t DictionaryIdFlag = 0x01;
+constexpr std::uint8_t VersionMask = 0xC0;
+constexpr std::uint8_t SupportedVersion = 0x40;
+
+std::uint32_t readUint32LE(const unsigned char* data) {
+    return static_cast<std::uint32_t>(data[0])
+           | (static_cast<std::uint32_t>(data[1]) << 8)
+           | (static_cast<std::uint32_t>(data[2]) << 16)
+           | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+bool fail(QString* error, const QString& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+// Blocks are decoded into one contiguous output buffer, so linked blocks can reference
+// earlier output without a separate dictionary.
+bool decodeBlock(
+    const unsigned char* source,
+    const std::size_t sourceSize,
+    char* output,
+    const std::size_t outputSize,
+    std::size_t& position,
+    QString* error
+) {
+    const auto* const end = source + sourceSize;
+    const auto* input = source;
+
+    const auto readLength = [&](std::size_t length) -> std::size_t {
+        if (length != 15) {
+            return length;
+        }
+        while (input < end) {
+            const auto value = *input++;
+            length += value;
+            if (value != 255) {
+                break;
+            }
+        }
+        return length;
+    };
+
+    while (input < end) {
+        const auto token = *input++;
+
+        const auto literalLength = readLength(token >> 4);
+        if (literalLength > static_cast<std::size_t>(end - input) || literalLength > outputSize - position) {
+            return fail(error, QStringLiteral("LZ4 literal run exceeds block bounds"));
+        }
+        std::memcpy(output + position, input, literalLength);
+        input += literalLength;
+        position += literalLength;
+
+        // The last sequence of a block carries literals only.
+        if (input == end) {
+            break;
+        }
+
+        if (end - input < 2) {
+            return fail(error, QStringLiteral("Truncated LZ4 match offset"));
+        }
+        const std::size_t offset = input[0] | (static_cast<std::size_t>(input[1]) << 8);
+        input += 2;
+        if (offset == 0 || offset > position) {
+            return fail(error, QStringLiteral("Invalid LZ4 match offset"));
+        }
+
+        const auto matchLength = readLength(token & 0x0F) + MinMatchLength;
+        if (matchLength > outputSize - position) {
+            return fail(error, QStringLiteral("LZ4 match exceeds output size"));
+        }
+
+        auto* destination = output + position;
+        const auto* match = destination - offset;
+        if (offset >= matchLength) {
+            std::memcpy(destination, match, matchLength);
+        } else {
+            for (std::size_t i = 0; i < matchLength; ++i) {
+                destination[i] = match[i];
+            }
+        }
+        position += matchLength;
+    }
+
+    return true;
+}
+} // namespace
+
+namespace Lz4Frame {
+
+bool decompressFrame(
+    const char* source,
+    const std::size_t sourceSize,
+    char* destination,
+    const std::size_t destinationSize,
+    QString* error
+) {
+    const auto* input = reinterpret_cast<const unsigned char*>(source);
+    const auto* const end = input + sourceSize;
+    std::size_t position = 0;
+
+    while (end - input >= 4) {
+        const auto magic = readUint32LE(input);
+        input += 4;
+
+        if ((magic & SkippableMagicMask) == SkippableMagic) {
+            if (end - input < 4 || readUint32LE(input) > static_cast<std::size_t>(end - input - 4)) {
+                return fail(error, QStringLiteral("Truncated LZ4 skippable frame"));
+            }
+            input += 4 + readUint32LE(input);
+            continue;
+        }
+        if (magic != FrameMagic) {
+            return fail(error, QStringLiteral("Invalid LZ4 frame magic"));
+        }
+
+        if (end - input < 3) {
+            return fail(error, QStringLiteral("Truncated LZ4 frame descriptor"));
+        }
+        const auto flags = input[0];
+        if ((flags & VersionMask) != SupportedVersion) {
+            return fail(error, QStringLiteral("Unsupported LZ4 frame version"));
+        }
+
+        // Descriptor: FLG, BD, optional content size and dictionary id, header checksum.
+        std::size_t descriptorSize = 3;
+        if (flags & ContentSizeFlag) {
+            descriptorSize += 8;
+        }
+        if (flags & DictionaryIdFlag) {
+            descriptorSize += 4;
+        }
+        if (static_cast<std::size_t>(end - input) < descriptorSize) {
+            return fail(error, QStringLiteral("Truncated LZ4 frame descriptor"));
+        }
+        input += descriptorSize;
+
+        while (true) {
+            if (end - input < 4) {
+                return fail(error, QStringLiteral("Truncated LZ4 block header"));
+            }
+            const auto blockHeader = readUint32LE(input);
+            input += 4;
+            if (blockHeader == 0) {
+                break;
+            }
+
+            const std::size_t blockSize = blockHeader & ~UncompressedBlockFlag;
+            if (blockSize > static_cast<std::size_t>(end - input)) {
+                return fail(error, QStringLiteral("Truncated LZ4 block"));
+            }
+
+            if (blockHeader & UncompressedBlockFlag) {
+                if (blockSize > destinationSize - position) {
+                    return fail(error, QStringLiteral("LZ4 block exceeds output size"));
+                }
+                std::memcpy(destination + position, input, blockSize);
+                position += blockSize;
+            } else if (!decodeBlock(input, blockSize, destination, destinationSize, position, error)) {
+                return false;
+            }
+            input += blockSize;
+
+            if (flags & BlockChecksumFlag) {
+                if (end - input < 4) {
+                    return fail(error, QStringLiteral("Truncated LZ4 block checksum"));
+                }
+                input += 4;
+            }
+        }
+
+        if (flags & ContentChecksumFlag) {
+            if (end - input < 4) {
+                return fail(error, QStringLiteral("Truncated LZ4 content checksum"));
+            }
+            input += 4;
+        }
+    }
+
+    if (position != destinationSize) {
+        return fail(error, QStringLiteral("LZ4 frame size does not match the record size"));
+    }
+    return true;
+}
+
+bool decompressBlock(
+    const char* source,
+    const std::size_t sourceSize,
+    char* destination,
+    const std::size_t destinationSize,
+    std::size_t* written,
+    QString* error
+) {
+    std::size_t position = 0;
+    const bool decoded = decodeBlock(
+        reinterpret_cast<const unsigned char*>(source),
+        sourceSize,
+        destination,
+        destinationSize,
+        position,
+        error
+    );
+    if (written) {
+        *written = position;
+    }
+    return decoded;
+}
+
+}
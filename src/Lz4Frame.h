@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QString>
+
+#include <cstddef>
+
+// Minimal LZ4 decoder for the frame format used by Skyrim SE BSAs and the raw block
+// format used by Starfield BA2s. Output must fit exactly into the caller's buffer.
+namespace Lz4Frame {
+
+[[nodiscard]] bool decompressFrame(
+    const char* source,
+    std::size_t sourceSize,
+    char* destination,
+    std::size_t destinationSize,
+    QString* error = nullptr
+);
+[[nodiscard]] bool decompressBlock(
+    const char* source,
+    std::size_t sourceSize,
+    char* destination,
+    std::size_t destinationSize,
+    std::size_t* written = nullptr,
+    QString* error = nullptr
+);
+
+}
@@ -0,0 +1,30 @@
+#include "MappedFile.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace MappedFile {
+
+ArchiveAccess::ExtractedBytes read(const QString& path) {
+    auto file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        qWarning("Failed to read loose file '%s'", qUtf8Printable(path));
+        return {};
+    }
+    if (file->size() == 0) {
+        return {};
+    }
+
+    if (const auto* data = file->map(0, file->size())) {
+        const std::span bytes(reinterpret_cast<const char*>(data), static_cast<std::size_t>(file->size()));
+        return {std::move(file), bytes};
+    }
+    return ArchiveAccess::ExtractedBytes(file->readAll());
+}
+
+}
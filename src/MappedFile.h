@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ArchiveAccess.h"
+
+#include <QString>
+
+// Read-only access to whole loose files. The returned bytes keep the file open and mapped
+// for as long as they are referenced, so page-cache hits are never copied; files that
+// cannot be mapped fall back to an owned buffer. Thread-safe.
+namespace MappedFile {
+
+[[nodiscard]] ArchiveAccess::ExtractedBytes read(const QString& path);
+
+}
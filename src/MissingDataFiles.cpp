@@ -0,0 +1,25 @@
+#include "MissingDataFiles.h"
+
+#include <utility>
+
+MissingDataFiles& MissingDataFiles::instance() {
+    static MissingDataFiles missingFiles;
+    return missingFiles;
+}
+
+bool MissingDataFiles::contains(const QString& sourceKey, const QString& dataPath) const {
+    const DataPathKey pathKey(sourceKey + dataPath);
+    const std::scoped_lock lock(m_Mutex);
+    return m_Paths.contains(pathKey);
+}
+
+void MissingDataFiles::insert(const QString& sourceKey, const QString& dataPath) {
+    auto pathKey = DataPathKey(sourceKey + dataPath);
+    const std::scoped_lock lock(m_Mutex);
+    m_Paths.insert(std::move(pathKey));
+}
+
+void MissingDataFiles::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    m_Paths.clear();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "DataPathKey.h"
+
+#include <QSet>
+#include <QString>
+
+#include <mutex>
+
+// Process-wide set of data paths that a texture source found neither as a loose file nor in
+// any archive, so repeated misses skip the MO2 and archive lookups. MO2 mod list, plugin
+// and profile changes clear it.
+class MissingDataFiles final {
+public:
+    static MissingDataFiles& instance();
+
+    [[nodiscard]] bool contains(const QString& sourceKey, const QString& dataPath) const;
+    void insert(const QString& sourceKey, const QString& dataPath);
+    void clear();
+
+private:
+    MissingDataFiles() = default;
+
+    mutable std::mutex m_Mutex;
+    QSet<DataPathKey> m_Paths;
+};
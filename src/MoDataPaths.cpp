@@ -1,19 +1,40 @@
 #include "MoDataPaths.h"
+#include "DirectorySnapshots.h"
 
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
 #include <QStringList>
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
 #include <uibase/game_features/dataarchives.h>
 #include <uibase/game_features/igamefeatures.h>
-#include <uibase/ifiletree.h>
 #include <uibase/imodinterface.h>
 #include <uibase/imoinfo.h>
 #include <uibase/iplugingame.h>
 
 namespace {
+// Mod entries remember the directory they were listed from, so a mod that is renamed or
+// replaced under the same name is listed again.
+struct ModArchives {
+    QString modPath;
+    QStringList archivePaths;
+};
+
+struct ArchiveListCache {
+    std::mutex mutex;
+    QHash<QString, ModArchives> mods;
+    std::optional<QStringList> game;
+};
+
+ArchiveListCache& archiveListCache() {
+    static ArchiveListCache cache;
+    return cache;
+}
+
 const MOBase::IProfile* profilePointer(const MOBase::IProfile* profile) {
     return profile;
 }
@@ -37,10 +58,6 @@ void appendUnique(QStringList& values, const QString& value) {
     }
 }
 
-bool isArchiveName(const QString& name) {
-    return name.endsWith(".bsa", Qt::CaseInsensitive) || name.endsWith(".ba2", Qt::CaseInsensitive);
-}
-
 void appendResolvedArchiveName(MOBase::IOrganizer* organizer, QStringList& archivePaths, const QString& archiveName) {
     appendUnique(archivePaths, MoDataPaths::resolveDataPath(organizer, archiveName));
 }
@@ -89,32 +106,41 @@ QString resolveDataPath(MOBase::IOrganizer* organizer, const QString& path) {
     }
 
     const auto dataPath = game->dataDirectory().absoluteFilePath(QDir::cleanPath(path));
-    return QFileInfo::exists(dataPath) ? QDir::fromNativeSeparators(QFileInfo(dataPath).absoluteFilePath()) : QString();
+    if (!DirectorySnapshots::instance().exists(dataPath)) {
+        return {};
+    }
+    return QDir::fromNativeSeparators(QFileInfo(dataPath).absoluteFilePath());
 }
 
 QStringList archivePathsFromMod(MOBase::IModInterface* mod) {
-    QStringList archivePaths;
-    if (!mod) {
-        return archivePaths;
-    }
+    return mod ? archivePathsFromMod(mod->name(), mod->absolutePath()) : QStringList();
+}
 
-    const auto fileTree = mod->fileTree();
-    if (!fileTree) {
-        return archivePaths;
+QStringList archivePathsFromMod(const QString& modName, const QString& modPath) {
+    if (modName.isEmpty() || modPath.isEmpty()) {
+        return {};
     }
 
-    for (auto it = fileTree->begin(); it != fileTree->end(); ++it) {
-        const auto fileInfo = *it;
-        if (!fileInfo || !fileInfo->isFile() || !isArchiveName(fileInfo->name())) {
-            continue;
+    auto& cache = archiveListCache();
+    {
+        const std::scoped_lock lock(cache.mutex);
+        if (const auto it = cache.mods.constFind(modName); it != cache.mods.cend() && it->modPath == modPath) {
+            return it->archivePaths;
         }
+    }
 
-        const QFileInfo archiveInfo(QDir(mod->absolutePath()).filePath(fileInfo->name()));
-        if (archiveInfo.exists() && archiveInfo.isFile()) {
-            appendUnique(archivePaths, QDir::fromNativeSeparators(archiveInfo.absoluteFilePath()));
-        }
+    QStringList archivePaths;
+    const auto archives = QDir(modPath).entryInfoList(
+        {"*.bsa", "*.ba2"},
+        QDir::Files | QDir::Readable,
+        QDir::Name | QDir::IgnoreCase
+    );
+    for (const auto& archiveInfo : archives) {
+        appendUnique(archivePaths, QDir::fromNativeSeparators(archiveInfo.absoluteFilePath()));
     }
 
+    const std::scoped_lock lock(cache.mutex);
+    cache.mods.insert(modName, {.modPath = modPath, .archivePaths = archivePaths});
     return archivePaths;
 }
 
@@ -124,6 +150,14 @@ QStringList archivePathsFromGame(MOBase::IOrganizer* organizer) {
         return archivePaths;
     }
 
+    auto& cache = archiveListCache();
+    {
+        const std::scoped_lock lock(cache.mutex);
+        if (cache.game) {
+            return *cache.game;
+        }
+    }
+
     auto* const features = organizer->gameFeatures();
     if (!features) {
         return archivePaths;
@@ -138,7 +172,28 @@ QStringList archivePathsFromGame(MOBase::IOrganizer* organizer) {
     appendResolvedArchiveNames(organizer, archivePaths, gameArchives->vanillaArchives());
     appendGameDataArchiveFiles(organizer, archivePaths);
 
+    const std::scoped_lock lock(cache.mutex);
+    cache.game = archivePaths;
     return archivePaths;
 }
 
+void invalidateModArchives(const QString& modName) {
+    auto& cache = archiveListCache();
+    const std::scoped_lock lock(cache.mutex);
+    cache.mods.remove(modName);
+}
+
+void invalidateGameArchives() {
+    auto& cache = archiveListCache();
+    const std::scoped_lock lock(cache.mutex);
+    cache.game.reset();
+}
+
+void invalidateArchiveLists() {
+    auto& cache = archiveListCache();
+    const std::scoped_lock lock(cache.mutex);
+    cache.mods.clear();
+    cache.game.reset();
+}
+
 }
@@ -12,11 +12,19 @@ namespace MoDataPaths {
 
 QString resolveDataPath(MOBase::IOrganizer* organizer, const QString& path);
 
-// Returned in the mod's file-tree order, with paths resolved from the owning mod
+// Returned in name order, like the mod's file tree, with paths resolved from the owning mod
 // directory so duplicate archive names in different mods remain distinct.
+// Cached per mod until invalidated.
 QStringList archivePathsFromMod(MOBase::IModInterface* mod);
+// Lists the mod directory without MO2, so it may run on any thread.
+QStringList archivePathsFromMod(const QString& modName, const QString& modPath);
 
-// Returned in lookup-priority order: later profile archives first.
+// Returned in lookup-priority order: later profile archives first. Cached until invalidated.
 QStringList archivePathsFromGame(MOBase::IOrganizer* organizer);
 
+// Called from MO2 change notifications; the next lookup walks the file tree again.
+void invalidateModArchives(const QString& modName);
+void invalidateGameArchives();
+void invalidateArchiveLists();
+
 }
@@ -0,0 +1,72 @@
+#include "NifDataCache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+NifDataCache& NifDataCache::instance() {
+    static NifDataCache cache;
+    return cache;
+}
+
+QString NifDataCache::sourceKey(const QString& archivePath, const QString& dataPath) {
+    const QFileInfo archiveInfo(archivePath);
+    if (archivePath.isEmpty() || dataPath.isEmpty() || !archiveInfo.isFile()) {
+        return {};
+    }
+
+    return QStringLiteral("%1|%2|%3|%4")
+        .arg(QDir::fromNativeSeparators(archiveInfo.absoluteFilePath()).toLower())
+        .arg(archiveInfo.size())
+        .arg(archiveInfo.lastModified().toMSecsSinceEpoch())
+        .arg(QDir::fromNativeSeparators(dataPath).toLower());
+}
+
+std::optional<QByteArray> NifDataCache::find(const QString& sourceKey) {
+    const std::scoped_lock lock(m_Mutex);
+    if (const auto* cached = m_Cache.find(sourceKey)) {
+        return cached->data;
+    }
+    return std::nullopt;
+}
+
+void NifDataCache::insert(const QString& sourceKey, const QByteArray& data) {
+    if (data.isEmpty()) {
+        return;
+    }
+
+    const std::scoped_lock lock(m_Mutex);
+    m_Cache.insert(sourceKey, {.data = data, .fingerprint = std::nullopt}, static_cast<std::size_t>(data.size()));
+}
+
+std::optional<std::uint64_t> NifDataCache::fingerprint(const QString& sourceKey) const {
+    const std::scoped_lock lock(m_Mutex);
+    const auto* cached = m_Cache.peek(sourceKey);
+    return cached ? cached->fingerprint : std::nullopt;
+}
+
+void NifDataCache::setFingerprint(const QString& sourceKey, const std::uint64_t fingerprint) {
+    const std::scoped_lock lock(m_Mutex);
+    if (auto* cached = m_Cache.peek(sourceKey)) {
+        cached->fingerprint = fingerprint;
+    }
+}
+
+void NifDataCache::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    const auto stats = m_Cache.stats();
+    qDebug(
+        "Clearing NIF data cache: %llu hits, %llu misses, %llu evictions",
+        static_cast<unsigned long long>(stats.hits),
+        static_cast<unsigned long long>(stats.misses),
+        static_cast<unsigned long long>(stats.evictions)
+    );
+
+    m_Cache.clear();
+}
+
+NifDataCacheStats NifDataCache::stats() const {
+    const std::scoped_lock lock(m_Mutex);
+    return m_Cache.stats();
+}
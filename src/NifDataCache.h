@@ -0,0 +1,45 @@
+#pragma once
+
+#include "LruCache.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+using NifDataCacheStats = LruCacheStats;
+
+// Process-wide LRU of NIF bytes extracted from archives, so switching between providers
+// of one mesh extracts each copy at most once. Keys include the archive's size and
+// modification time; entries of rewritten archives are never hit again and age out.
+class NifDataCache final {
+public:
+    static constexpr std::size_t MemoryBudget = std::size_t {64} * 1024 * 1024;
+
+    static NifDataCache& instance();
+
+    // Stats the archive; returns an empty key when it does not exist.
+    [[nodiscard]] static QString sourceKey(const QString& archivePath, const QString& dataPath);
+
+    [[nodiscard]] std::optional<QByteArray> find(const QString& sourceKey);
+    void insert(const QString& sourceKey, const QByteArray& data);
+    // Fingerprints live with the cached bytes and are dropped when those are evicted.
+    [[nodiscard]] std::optional<std::uint64_t> fingerprint(const QString& sourceKey) const;
+    void setFingerprint(const QString& sourceKey, std::uint64_t fingerprint);
+    void clear();
+    [[nodiscard]] NifDataCacheStats stats() const;
+
+private:
+    struct CachedData {
+        QByteArray data;
+        std::optional<std::uint64_t> fingerprint;
+    };
+
+    NifDataCache() = default;
+
+    mutable std::mutex m_Mutex;
+    LruCache<CachedData> m_Cache {MemoryBudget};
+};
@@ -0,0 +1,62 @@
+#include "NifFileCache.h"
+
+#include <QDebug>
+
+#include <NifFile.hpp>
+
+#include <utility>
+
+namespace {
+// Positions, normals, tangents, bitangents, UVs and colors after validation.
+constexpr std::size_t VertexBytes = sizeof(nifly::Vector3) * 4 + sizeof(nifly::Vector2) + sizeof(nifly::Color4);
+constexpr std::size_t TriangleBytes = sizeof(nifly::Triangle);
+constexpr std::size_t BlockBytes = 256;
+} // namespace
+
+NifFileCache& NifFileCache::instance() {
+    static NifFileCache cache;
+    return cache;
+}
+
+std::size_t NifFileCache::estimateBytes(nifly::NifFile* nifFile) {
+    auto bytes = std::size_t {nifFile->GetHeader().GetNumBlocks()} * BlockBytes;
+    for (auto* const shape : nifFile->GetShapes()) {
+        if (shape) {
+            bytes += shape->GetNumVertices() * VertexBytes + shape->GetNumTriangles() * TriangleBytes;
+        }
+    }
+    return bytes;
+}
+
+std::shared_ptr<nifly::NifFile> NifFileCache::find(const QString& sourceKey) {
+    const std::scoped_lock lock(m_Mutex);
+    const auto* nifFile = m_Cache.find(sourceKey);
+    return nifFile ? *nifFile : nullptr;
+}
+
+void NifFileCache::insert(const QString& sourceKey, std::shared_ptr<nifly::NifFile> nifFile, const std::size_t bytes) {
+    if (!nifFile) {
+        return;
+    }
+
+    const std::scoped_lock lock(m_Mutex);
+    m_Cache.insert(sourceKey, std::move(nifFile), bytes);
+}
+
+void NifFileCache::clear() {
+    const std::scoped_lock lock(m_Mutex);
+    const auto stats = m_Cache.stats();
+    qDebug(
+        "Clearing NIF file cache: %llu hits, %llu misses, %llu evictions",
+        static_cast<unsigned long long>(stats.hits),
+        static_cast<unsigned long long>(stats.misses),
+        static_cast<unsigned long long>(stats.evictions)
+    );
+
+    m_Cache.clear();
+}
+
+NifFileCacheStats NifFileCache::stats() const {
+    const std::scoped_lock lock(m_Mutex);
+    return m_Cache.stats();
+}
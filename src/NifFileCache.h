@@ -0,0 +1,39 @@
+#pragma once
+
+#include "LruCache.h"
+
+#include <QString>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace nifly {
+class NifFile;
+}
+
+using NifFileCacheStats = LruCacheStats;
+
+// Process-wide LRU of parsed NIFs, so arrowing back to a recently previewed mesh skips
+// extraction and parsing. Cached files are validated at load and must not be modified
+// afterwards, since any number of previews may render the same instance.
+class NifFileCache final {
+public:
+    static constexpr std::size_t MemoryBudget = std::size_t {256} * 1024 * 1024;
+
+    static NifFileCache& instance();
+
+    // Rough in-memory size of a parsed file, dominated by its vertex and triangle arrays.
+    [[nodiscard]] static std::size_t estimateBytes(nifly::NifFile* nifFile);
+
+    [[nodiscard]] std::shared_ptr<nifly::NifFile> find(const QString& sourceKey);
+    void insert(const QString& sourceKey, std::shared_ptr<nifly::NifFile> nifFile, std::size_t bytes);
+    void clear();
+    [[nodiscard]] NifFileCacheStats stats() const;
+
+private:
+    NifFileCache() = default;
+
+    mutable std::mutex m_Mutex;
+    LruCache<std::shared_ptr<nifly::NifFile>> m_Cache {MemoryBudget};
+};
@@ -1,4 +1,5 @@
 #include "NifPreviewPane.h"
+#include "ArchiveIndexer.h"
 #include "NifWidget.h"
 
 #include <QComboBox>
@@ -6,6 +7,7 @@
 #include <QFrame>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QMetaObject>
 #include <QResizeEvent>
 #include <QSizePolicy>
 #include <QToolButton>
@@ -120,6 +122,10 @@ NifPreviewPane::NifPreviewPane(MOBase::IOrganizer* organizer, QWidget* parent)
     });
 
     updateTextureControls();
+
+    ArchiveIndexer::subscribe(this, [this] {
+        refreshTextureSources();
+    });
 }
 
 void NifPreviewPane::resizeEvent(QResizeEvent* event) {
@@ -216,6 +222,18 @@ void NifPreviewPane::selectRelativeTextureSource(const int offset) {
     reloadCurrentNifWidget();
 }
 
+void NifPreviewPane::refreshTextureSources() {
+    const auto previousKey = textureProviderKey(m_Controller.currentTextureSourceProvider());
+    if (!m_Controller.refreshTextureSources()) {
+        return;
+    }
+
+    updateTextureSourceComboItems();
+    if (textureProviderKey(m_Controller.currentTextureSourceProvider()) != previousKey) {
+        reloadCurrentNifWidget();
+    }
+}
+
 void NifPreviewPane::updateControls() {
     const auto hasMultipleProviders = m_Controller.providers().size() > 1;
     m_PrevButton->setEnabled(hasMultipleProviders);
@@ -268,8 +286,9 @@ void NifPreviewPane::updateTextureControls() {
     m_NextTextureButton->setEnabled(hasMultipleTextureSources);
     m_TextureSourceCombo->setEnabled(hasMultipleTextureSources);
 
-    const auto toolTip = makeTextureToolTipText(textureSources, currentTextureSourceIndex);
-    m_TextureLabel->setText(makeTextureSummaryText(textureSources));
+    const bool resolving = m_Controller.currentNifFile() && textureSources.providers.isEmpty();
+    const auto toolTip = resolving ? QString() : makeTextureToolTipText(textureSources, currentTextureSourceIndex);
+    m_TextureLabel->setText(resolving ? tr("Textures: resolving…") : makeTextureSummaryText(textureSources));
     m_TextureLabel->setToolTip(toolTip);
     m_TextureSourceCombo->setToolTip(toolTip);
 
@@ -297,7 +316,12 @@ void NifPreviewPane::updateTextureSourceComboWidth() {
 }
 
 void NifPreviewPane::loadCurrentProvider() {
-    const auto result = m_Controller.loadCurrentProvider();
+    showLoadResult(m_Controller.loadCurrentProvider(this, [this](const PreviewPaneLoadResult& result) {
+        showLoadResult(result);
+    }));
+}
+
+void NifPreviewPane::showLoadResult(const PreviewPaneLoadResult& result) {
     m_TitleLabel->setText(result.title);
     m_StatsLabel->setText(result.statsText);
     updateTextureSourceComboItems();
@@ -307,11 +331,29 @@ void NifPreviewPane::loadCurrentProvider() {
             m_TitleLabel->clear();
             setViewWidget(new QLabel(tr("No previewable NIF version"), this));
             return;
+        case PreviewPaneLoadStatus::Loading: setViewWidget(new QLabel(tr("Loading…"), this)); return;
         case PreviewPaneLoadStatus::Failed: setViewWidget(new QLabel(tr("Failed to load preview"), this)); return;
-        case PreviewPaneLoadStatus::Loaded: reloadCurrentNifWidget(); return;
+        case PreviewPaneLoadStatus::Loaded:
+            reloadCurrentNifWidget();
+            resolveTextureSourcesLater();
+            return;
     }
 }
 
+// Texture sources query MO2 and read materials, so they are resolved after the preview is
+// shown; until then it renders with Auto.
+void NifPreviewPane::resolveTextureSourcesLater() {
+    QMetaObject::invokeMethod(
+        this,
+        [this, nifFile = m_Controller.currentNifFile()] {
+            if (m_Controller.currentNifFile() == nifFile) {
+                refreshTextureSources();
+            }
+        },
+        Qt::QueuedConnection
+    );
+}
+
 void NifPreviewPane::reloadCurrentNifWidget() {
     const auto nifFile = m_Controller.currentNifFile();
     if (!nifFile) {
@@ -46,12 +46,15 @@ private:
     void selectRelativeProvider(int offset);
     void selectTextureSource(int index);
     void selectRelativeTextureSource(int offset);
+    void refreshTextureSources();
     void updateControls();
     void updateSourceComboWidth();
     void updateTextureSourceComboItems();
     void updateTextureControls();
     void updateTextureSourceComboWidth();
     void loadCurrentProvider();
+    void showLoadResult(const PreviewPaneLoadResult& result);
+    void resolveTextureSourcesLater();
     void reloadCurrentNifWidget();
     void setViewWidget(QWidget* widget);
 
@@ -1,7 +1,16 @@
 #include "NifPreviewSource.h"
 #include "ArchiveAccess.h"
+#include "ArchiveIndex.h"
+#include "ArchiveIndexer.h"
+#include "ContentHash.h"
+#include "DirectorySnapshots.h"
+#include "MappedFile.h"
 #include "MoDataPaths.h"
+#include "NifDataCache.h"
+#include "ShapeRenderGeometry.h"
+#include "SpanStream.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
@@ -9,19 +18,17 @@
 #include <QStringList>
 
 #include <algorithm>
-#include <filesystem>
 #include <limits>
 #include <ranges>
-#include <sstream>
 #include <uibase/imodinterface.h>
 #include <uibase/imodlist.h>
 #include <uibase/imoinfo.h>
 #include <uibase/iplugingame.h>
 #include <utility>
 
-#include <libbsarch/bs_archive.h>
-
 namespace {
+constexpr qint64 MaxEmbeddedNameBytes = 256;
+
 QString normalizeDataPath(QString path) {
     path = QDir::fromNativeSeparators(path).trimmed();
     while (path.startsWith('/')) {
@@ -128,16 +135,8 @@ bool hasArchiveProvider(
 }
 
 QByteArray extractArchiveFile(const QString& archivePath, const QString& virtualPath) {
-    libbsarch::bs_archive archive;
-
-    QString error;
-    if (!ArchiveAccess::loadArchive(archive, archivePath, &error)) {
-        qWarning("Failed to load BSA archive '%s': %s", qUtf8Printable(archivePath), qUtf8Printable(error));
-        return {};
-    }
-
     ArchiveAccess::ExtractResult result;
-    auto data = ArchiveAccess::extractBytes(archive, virtualPath, std::numeric_limits<int>::max(), &result);
+    auto data = ArchiveAccess::extractBytes(archivePath, virtualPath, std::numeric_limits<int>::max(), &result);
     if (result.status == ArchiveAccess::ExtractStatus::Oversized) {
         qWarning("Skipping oversized NIF '%s' from BSA '%s'", qUtf8Printable(virtualPath), qUtf8Printable(archivePath));
     }
@@ -145,6 +144,17 @@ QByteArray extractArchiveFile(const QString& archivePath, const QString& virtual
     return data;
 }
 
+QByteArray archiveProviderData(const NifPreviewProvider& provider) {
+    const auto sourceKey = NifDataCache::sourceKey(provider.archivePath, provider.virtualPath);
+    if (auto cached = NifDataCache::instance().find(sourceKey)) {
+        return *std::move(cached);
+    }
+
+    auto data = extractArchiveFile(provider.archivePath, provider.virtualPath);
+    NifDataCache::instance().insert(sourceKey, data);
+    return data;
+}
+
 QString providerDisplayName(const QString& sourceName, const QString& archivePath) {
     auto archiveName = QFileInfo(archivePath).fileName();
     if (sourceName.isEmpty()) {
@@ -160,7 +170,9 @@ void addLooseProvider(
     const QString& virtualPath,
     const QString& absolutePath
 ) {
-    if (absolutePath.isEmpty() || !QFileInfo::exists(absolutePath) || hasProviderPath(providers, absolutePath)) {
+    if (absolutePath.isEmpty()
+        || !DirectorySnapshots::instance().isFile(absolutePath)
+        || hasProviderPath(providers, absolutePath)) {
         return;
     }
 
@@ -171,7 +183,11 @@ void addLooseProvider(
             .absolutePath = QDir::fromNativeSeparators(QFileInfo(absolutePath).absoluteFilePath()),
             .archivePath = {},
             .archiveName = {},
-            .data = {}}
+            .data = {},
+            .dataSize = -1,
+            .packedSize = 0,
+            .compressed = false,
+            .fingerprint = std::nullopt}
     );
 }
 
@@ -179,8 +195,9 @@ void addArchiveProvider(
     QVector<NifPreviewProvider>& providers,
     const QString& sourceName,
     const QString& virtualPath,
-    const QString& archivePath
+    const ArchiveIndexLocation& location
 ) {
+    const auto& archivePath = location.archivePath;
     const QFileInfo archiveInfo(archivePath);
     if (archivePath.isEmpty() || !archiveInfo.exists() || !archiveInfo.isFile()) {
         return;
@@ -191,11 +208,6 @@ void addArchiveProvider(
         return;
     }
 
-    auto archiveData = extractArchiveFile(absoluteArchivePath, virtualPath);
-    if (archiveData.isEmpty()) {
-        return;
-    }
-
     providers.push_back(
         {.displayName = providerDisplayName(sourceName, absoluteArchivePath),
             .virtualPath = virtualPath,
@@ -203,10 +215,37 @@ void addArchiveProvider(
             .absolutePath = {},
             .archivePath = absoluteArchivePath,
             .archiveName = archiveInfo.fileName(),
-            .data = std::move(archiveData)}
+            .data = {},
+            .dataSize = location.size > 0 ? static_cast<qint64>(location.size) : -1,
+            .packedSize = location.packedSize,
+            .compressed = location.compressed,
+            .fingerprint = std::nullopt}
     );
 }
 
+// Finds the archives holding virtualPath from their directory tables only; bytes are
+// extracted when a provider is loaded.
+void addArchiveProviders(
+    QVector<NifPreviewProvider>& providers,
+    const QString& owner,
+    const QString& sourceName,
+    const QStringList& archivePaths,
+    const QString& virtualPath
+) {
+    if (ArchiveIndexer::ensureIndexed(owner, archivePaths)) {
+        for (const auto& location : ArchiveIndex::instance().locate(owner, virtualPath)) {
+            addArchiveProvider(providers, sourceName, virtualPath, location);
+        }
+        return;
+    }
+
+    for (const auto& archivePath : archivePaths) {
+        if (ArchiveAccess::containsDataPath(archivePath, virtualPath)) {
+            addArchiveProvider(providers, sourceName, virtualPath, {.archivePath = archivePath});
+        }
+    }
+}
+
 void addArchiveProvidersFromMod(
     QVector<NifPreviewProvider>& providers,
     MOBase::IModInterface* mod,
@@ -216,9 +255,7 @@ void addArchiveProvidersFromMod(
         return;
     }
 
-    for (const auto& archivePath : MoDataPaths::archivePathsFromMod(mod)) {
-        addArchiveProvider(providers, mod->name(), virtualPath, archivePath);
-    }
+    addArchiveProviders(providers, mod->name(), mod->name(), MoDataPaths::archivePathsFromMod(mod), virtualPath);
 }
 
 void addGameArchiveProviders(
@@ -232,10 +269,13 @@ void addGameArchiveProviders(
 
     const auto* const game = organizer->managedGame();
     const auto sourceName = game ? game->displayGameName() : QObject::tr("Game Data");
-
-    for (const auto& archivePath : MoDataPaths::archivePathsFromGame(organizer)) {
-        addArchiveProvider(providers, sourceName, virtualPath, archivePath);
-    }
+    addArchiveProviders(
+        providers,
+        ArchiveIndex::GameOwner,
+        sourceName,
+        MoDataPaths::archivePathsFromGame(organizer),
+        virtualPath
+    );
 }
 
 void orderOriginsForPreview(QStringList& origins) {
@@ -260,21 +300,57 @@ int providerIndexForPath(const QVector<NifPreviewProvider>& providers, const QSt
     return -1;
 }
 
-int providerIndexForArchiveData(const QVector<NifPreviewProvider>& providers, const QByteArray& fileData) {
+bool sizeMayMatch(const NifPreviewProvider& provider, const qint64 size) {
+    if (provider.dataSize >= 0) {
+        return provider.dataSize == size;
+    }
+    // Uncompressed BSA records hold the data plus an optional embedded file name.
+    if (provider.packedSize > 0 && !provider.compressed) {
+        return size <= provider.packedSize && provider.packedSize - size <= MaxEmbeddedNameBytes;
+    }
+    return true;
+}
+
+std::optional<std::uint64_t> archiveProviderFingerprint(const NifPreviewProvider& provider) {
+    const auto sourceKey = NifDataCache::sourceKey(provider.archivePath, provider.virtualPath);
+    if (const auto fingerprint = NifDataCache::instance().fingerprint(sourceKey)) {
+        return fingerprint;
+    }
+
+    const auto data = archiveProviderData(provider);
+    if (data.isEmpty()) {
+        return std::nullopt;
+    }
+
+    const auto fingerprint = ContentHash::xxh64(data.constData(), static_cast<std::size_t>(data.size()));
+    NifDataCache::instance().setFingerprint(sourceKey, fingerprint);
+    return fingerprint;
+}
+
+// Narrows candidates by the record sizes in the archive directories, so only copies of
+// the same size are extracted and hashed; their fingerprints stay on the providers.
+int providerIndexForArchiveData(
+    QVector<NifPreviewProvider>& providers,
+    const QByteArray& fileData,
+    std::optional<std::uint64_t>& fileFingerprint
+) {
     if (fileData.isEmpty()) {
         return -1;
     }
 
     for (int i = 0; i < providers.size(); ++i) {
-        const auto& provider = providers[i];
-        if (provider.kind != NifPreviewProviderKind::Archive) {
+        auto& provider = providers[i];
+        if (provider.kind != NifPreviewProviderKind::Archive || !sizeMayMatch(provider, fileData.size())) {
             continue;
         }
 
-        const auto archiveData = provider.data.isEmpty()
-                                     ? extractArchiveFile(provider.archivePath, provider.virtualPath)
-                                     : provider.data;
-        if (archiveData.size() == fileData.size() && archiveData == fileData) {
+        if (!provider.fingerprint) {
+            provider.fingerprint = archiveProviderFingerprint(provider);
+        }
+        if (!fileFingerprint) {
+            fileFingerprint = ContentHash::xxh64(fileData.constData(), static_cast<std::size_t>(fileData.size()));
+        }
+        if (provider.fingerprint == fileFingerprint) {
             return i;
         }
     }
@@ -287,7 +363,8 @@ void addInMemoryProvider(
     const QString& displayName,
     const QString& virtualPath,
     const QString& fileName,
-    const QByteArray& fileData
+    const QByteArray& fileData,
+    const std::optional<std::uint64_t> fingerprint
 ) {
     providers.insert(
         providers.begin(),
@@ -297,7 +374,11 @@ void addInMemoryProvider(
             .absolutePath = fileName,
             .archivePath = {},
             .archiveName = {},
-            .data = fileData}
+            .data = fileData,
+            .dataSize = fileData.size(),
+            .packedSize = 0,
+            .compressed = false,
+            .fingerprint = fingerprint}
     );
 }
 } // namespace
@@ -331,7 +412,9 @@ NifPreviewSourceSet NifPreviewSourceResolver::resolve(
     }
 
     if (!fileData.isEmpty()) {
-        if (const auto currentIndex = providerIndexForArchiveData(sourceSet.providers, fileData); currentIndex >= 0) {
+        std::optional<std::uint64_t> fingerprint;
+        if (const auto currentIndex = providerIndexForArchiveData(sourceSet.providers, fileData, fingerprint);
+            currentIndex >= 0) {
             sourceSet.currentIndex = currentIndex;
         } else {
             addInMemoryProvider(
@@ -339,7 +422,8 @@ NifPreviewSourceSet NifPreviewSourceResolver::resolve(
                 QObject::tr("Current Archive Preview"),
                 sourceSet.virtualPath,
                 normalizedFileName,
-                fileData
+                fileData,
+                fingerprint
             );
             sourceSet.currentIndex = 0;
         }
@@ -365,28 +449,63 @@ NifPreviewSourceSet NifPreviewSourceResolver::resolve(
     return sourceSet;
 }
 
+QString nifProviderCacheKey(const NifPreviewProvider& provider) {
+    switch (provider.kind) {
+        case NifPreviewProviderKind::LooseFile: {
+            const QFileInfo fileInfo(provider.absolutePath);
+            if (!fileInfo.isFile()) {
+                return {};
+            }
+            return QStringLiteral("loose|%1|%2|%3")
+                .arg(QDir::fromNativeSeparators(fileInfo.absoluteFilePath()).toLower())
+                .arg(fileInfo.size())
+                .arg(fileInfo.lastModified().toMSecsSinceEpoch());
+        }
+        case NifPreviewProviderKind::Archive: {
+            const auto sourceKey = NifDataCache::sourceKey(provider.archivePath, provider.virtualPath);
+            return sourceKey.isEmpty() ? QString() : QStringLiteral("archive|") + sourceKey;
+        }
+        case NifPreviewProviderKind::InMemory: {
+            if (provider.data.isEmpty()) {
+                return {};
+            }
+            const auto fingerprint = provider.fingerprint
+                ? *provider.fingerprint
+                : ContentHash::xxh64(provider.data.constData(), static_cast<std::size_t>(provider.data.size()));
+            return QStringLiteral("memory|%1|%2").arg(provider.data.size()).arg(fingerprint, 16, 16, QLatin1Char('0'));
+        }
+    }
+
+    return {};
+}
+
 std::shared_ptr<nifly::NifFile> loadNifProvider(const NifPreviewProvider& provider) {
     std::shared_ptr<nifly::NifFile> nifFile;
 
     if (provider.kind == NifPreviewProviderKind::InMemory || provider.kind == NifPreviewProviderKind::Archive) {
-        const auto data = provider.kind == NifPreviewProviderKind::Archive && provider.data.isEmpty()
-                              ? extractArchiveFile(provider.archivePath, provider.virtualPath)
-                              : provider.data;
+        const auto data = provider.kind == NifPreviewProviderKind::Archive ? archiveProviderData(provider)
+                                                                           : provider.data;
         if (data.isEmpty()) {
             return nullptr;
         }
 
-        const std::string bytes(data.constData(), static_cast<std::size_t>(data.size()));
-        std::istringstream fileStream(bytes);
+        SpanStream fileStream({data.constData(), static_cast<std::size_t>(data.size())});
         nifFile = std::make_shared<nifly::NifFile>(fileStream);
     } else {
-        nifFile = std::make_shared<nifly::NifFile>(std::filesystem::path(provider.absolutePath.toStdWString()));
+        const auto bytes = MappedFile::read(provider.absolutePath);
+        if (bytes.isEmpty()) {
+            return nullptr;
+        }
+
+        SpanStream fileStream(bytes.bytes());
+        nifFile = std::make_shared<nifly::NifFile>(fileStream);
     }
 
     if (!nifFile || !nifFile->IsValid()) {
         return nullptr;
     }
 
+    validateNifGeometry(nifFile.get());
     return nifFile;
 }
 
@@ -6,7 +6,9 @@
 #include <QString>
 #include <QVector>
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 namespace MOBase {
 class IOrganizer;
@@ -25,7 +27,14 @@ struct NifPreviewProvider {
     QString absolutePath;
     QString archivePath;
     QString archiveName;
+    // Only set for in-memory previews; archive bytes are extracted on load.
     QByteArray data;
+    // Record layout from the archive index; dataSize is -1 and packedSize 0 when unknown.
+    qint64 dataSize = -1;
+    std::uint32_t packedSize = 0;
+    bool compressed = false;
+    // XXH64 of the NIF bytes, filled in once they have been hashed.
+    std::optional<std::uint64_t> fingerprint;
 };
 
 struct NifPreviewSourceSet {
@@ -43,5 +52,9 @@ public:
     );
 };
 
+// Identifies the provider's bytes for NifFileCache: loose path with size and mtime, archive
+// record, or the fingerprint of in-memory data. Empty when the file is gone.
+QString nifProviderCacheKey(const NifPreviewProvider& provider);
+// Parses and validates the provider's NIF; the result is safe to share between previews.
 std::shared_ptr<nifly::NifFile> loadNifProvider(const NifPreviewProvider& provider);
 QString makeNifStatsText(const nifly::NifFile* nifFile);
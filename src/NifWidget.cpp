@@ -9,11 +9,14 @@
 #include <QOpenGLVersionFunctionsFactory>
 #include <QWheelEvent>
 #include <algorithm>
+#include <chrono>
 #include <exception>
 #include <utility>
 
 namespace {
 constexpr int SceneTextureUnit = 0;
+// Keeps texture uploads from stalling interaction while a NIF's textures stream in.
+constexpr std::chrono::milliseconds TextureUploadBudget {8};
 
 QSharedPointer<Camera> makeCamera() {
     return {new Camera(), &Camera::deleteLater};
@@ -32,7 +35,7 @@ NifWidget::NifWidget(
     : QOpenGLWidget(parent, f)
     , m_NifFile {std::move(nifFile)}
     , m_MOInfo {organizer}
-    , m_TextureManager {std::make_unique<TextureManager>(organizer, std::move(textureSource))}
+    , m_TextureManager {std::make_unique<TextureManager>(organizer, std::move(textureSource), this)}
     , m_ShaderManager {std::make_unique<ShaderManager>(organizer)} {
     setCamera(std::move(camera));
 
@@ -170,6 +173,8 @@ void NifWidget::initializeGL() {
         }
     }
 
+    m_TextureManager->prefetchTextures(TextureSourceResolver::texturePaths(m_MOInfo, m_NifFile.get()));
+
     auto shapes = m_NifFile->GetShapes();
     for (auto& shape : shapes) {
         if (!shape) {
@@ -207,6 +212,11 @@ void NifWidget::paintGL() {
     if (!f) {
         return;
     }
+
+    if (m_TextureManager->processUploads(TextureUploadBudget)) {
+        update();
+    }
+
     f->glDepthMask(GL_TRUE);
     f->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
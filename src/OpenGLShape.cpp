@@ -15,6 +15,22 @@
 
 #include <NifFile.hpp>
 
+namespace {
+Fo4Material::Material fo4Material(
+    const nifly::NiShader* shader,
+    const ShaderManager::ShaderType shaderType,
+    const TextureManager* textureManager
+) {
+    if (shaderType == ShaderManager::FO4Default) {
+        return textureManager->getFo4Material(GetShaderMaterialPath(shader, ".bgsm"));
+    }
+    if (shaderType == ShaderManager::FO4EffectShader) {
+        return textureManager->getFo4Material(GetShaderMaterialPath(shader, ".bgem"));
+    }
+    return {};
+}
+} // namespace
+
 OpenGLShape::OpenGLShape(nifly::NifFile* nifFile, nifly::NiShape* niShape, TextureManager* textureManager)
     : m_Geometry {std::make_unique<OpenGLShapeGeometry>()}
     , m_Material {std::make_unique<OpenGLShapeMaterial>()}
@@ -38,6 +54,12 @@ OpenGLShape::OpenGLShape(nifly::NifFile* nifFile, nifly::NiShape* niShape, Textu
         m_Textures->load(nifFile, shader, m_ShaderType, isPBR, textureManager);
         m_Material->apply(shader, isPBR);
         m_DrawState->apply(nifFile, niShape, shader);
+
+        // The game reads FO4 shader values from the material file; the NIF block often holds placeholders.
+        if (const auto material = fo4Material(shader, m_ShaderType, textureManager); material.hasParameters) {
+            m_Material->applyFo4Material(material);
+            m_DrawState->applyFo4Material(material.parameters);
+        }
     } else {
         m_Textures->useDefaultTextures(textureManager);
     }
@@ -14,6 +14,36 @@ void OpenGLShapeDrawState::apply(nifly::NifFile* nifFile, nifly::NiShape* niShap
     }
 }
 
+void OpenGLShapeDrawState::applyFo4Material(const Fo4Material::Parameters& parameters) {
+    m_ZBufferWrite = parameters.has(Fo4Material::ZBufferWrite);
+    m_ZBufferTest = parameters.has(Fo4Material::ZBufferTest);
+    m_DoubleSided = parameters.has(Fo4Material::TwoSided);
+
+    m_AlphaTestEnable = parameters.has(Fo4Material::AlphaTest);
+    if (m_AlphaTestEnable) {
+        m_AlphaTestMode = GL_GREATER;
+        m_AlphaThreshold = parameters.alphaTestRef;
+    }
+
+    m_AlphaBlendEnable = parameters.alphaBlendMode != Fo4Material::AlphaBlendMode::None;
+    switch (parameters.alphaBlendMode) {
+        case Fo4Material::AlphaBlendMode::None:
+            break;
+        case Fo4Material::AlphaBlendMode::Standard:
+            m_SrcBlendMode = GL_SRC_ALPHA;
+            m_DstBlendMode = GL_ONE_MINUS_SRC_ALPHA;
+            break;
+        case Fo4Material::AlphaBlendMode::Additive:
+            m_SrcBlendMode = GL_SRC_ALPHA;
+            m_DstBlendMode = GL_ONE;
+            break;
+        case Fo4Material::AlphaBlendMode::Multiplicative:
+            m_SrcBlendMode = GL_DST_COLOR;
+            m_DstBlendMode = GL_ZERO;
+            break;
+    }
+}
+
 void OpenGLShapeDrawState::setupUniforms(QOpenGLShaderProgram* program) const {
     program->setUniformValue("alphaThreshold", m_AlphaThreshold);
     program->setUniformValue("alphaTestMode", static_cast<GLint>(m_AlphaTestEnable ? m_AlphaTestMode : GL_ALWAYS));
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Fo4Material.h"
+
 #include <QOpenGLFunctions_2_1>
 
 class QOpenGLShaderProgram;
@@ -13,6 +15,8 @@ class NiShape;
 class OpenGLShapeDrawState {
 public:
     void apply(nifly::NifFile* nifFile, nifly::NiShape* niShape, nifly::NiShader* shader);
+    // BGSM/BGEM alpha, depth and culling settings take precedence over the NIF's.
+    void applyFo4Material(const Fo4Material::Parameters& parameters);
     void setupUniforms(QOpenGLShaderProgram* program) const;
     void setupOpenGLState(QOpenGLFunctions_2_1* f, bool usesBlendedPass) const;
 
@@ -84,7 +84,6 @@ void OpenGLShapeGeometry::initialize(nifly::NifFile* nifFile, nifly::NiShape* ni
     auto binder = QOpenGLVertexArrayObject::Binder(glVertexArray);
 
     setDefaultVertexAttributes(f);
-    validateShapeGeometry(niShape);
 
     const auto geometry = prepareShapeRenderGeometry(nifFile, niShape);
     m_ModelMatrix = convertTransform(geometry.modelTransform);
@@ -6,6 +6,7 @@
 #include <NifFile.hpp>
 
 #include <algorithm>
+#include <array>
 
 namespace {
 bool usesEffectShader(const ShaderManager::ShaderType shaderType) {
@@ -28,6 +29,18 @@ QVector3D colorRgb(const QColor& color) {
     return {color.redF(), color.greenF(), color.blueF()};
 }
 
+QVector2D convertVector2(const std::array<float, 2>& vector) {
+    return {vector[0], vector[1]};
+}
+
+QVector3D convertVector3(const std::array<float, 3>& vector) {
+    return {vector[0], vector[1], vector[2]};
+}
+
+QColor convertColor(const std::array<float, 3>& color) {
+    return QColor::fromRgbF(color[0], color[1], color[2]);
+}
+
 QVector4D colorRgba(const QColor& color) {
     return {color.redF(), color.greenF(), color.blueF(), color.alphaF()};
 }
@@ -46,6 +59,50 @@ void OpenGLShapeMaterial::apply(nifly::NiShader* shader, const bool isPBR) {
     }
 }
 
+void OpenGLShapeMaterial::applyFo4Material(const Fo4Material::Material& material) {
+    const auto& parameters = material.parameters;
+    m_Alpha = parameters.alpha;
+    m_UvScale = convertVector2(parameters.uvScale);
+    m_UvOffset = convertVector2(parameters.uvOffset);
+    m_PaletteScale = parameters.grayscaleToPaletteScale;
+    m_GreyscaleColor = parameters.has(Fo4Material::GreyscaleToPaletteColor);
+    m_HasGlowMap = parameters.has(Fo4Material::Glowmap);
+    m_EnvReflection = parameters.environmentMapScale;
+
+    if (material.effect) {
+        m_GlowColor = convertColor(parameters.baseColor);
+        m_GlowMult = parameters.baseColorScale;
+        m_HasWeaponBlood = parameters.has(Fo4Material::Blood);
+        m_GreyscaleAlpha = parameters.has(Fo4Material::GreyscaleToPaletteAlpha);
+        m_UseFalloff = parameters.has(Fo4Material::Falloff);
+        const auto& falloff = parameters.falloffParams;
+        m_FalloffParams = QVector4D(falloff[0], falloff[1], falloff[2], falloff[3]);
+        m_FalloffDepth = parameters.softDepth;
+        return;
+    }
+
+    m_SpecColor = convertVector3(parameters.specularColor);
+    m_SpecStrength = parameters.specularMult;
+    m_SpecGlossiness = parameters.smoothness;
+    m_FresnelPower = parameters.fresnelPower;
+
+    m_HasEmit = parameters.has(Fo4Material::Emit);
+    m_GlowColor = convertColor(parameters.emittanceColor);
+    m_GlowMult = parameters.emittanceMult;
+
+    m_HasRimlight = parameters.has(Fo4Material::RimLighting);
+    m_RimPower = parameters.rimPower;
+    m_HasBacklight = parameters.has(Fo4Material::BackLighting);
+    m_BacklightPower = parameters.backLightPower;
+    m_HasSoftlight = parameters.has(Fo4Material::SubsurfaceLighting);
+    m_SubsurfaceRolloff = m_HasSoftlight ? parameters.subsurfaceRolloff : 0.0f;
+
+    m_HasTintColor = parameters.has(Fo4Material::HairTint);
+    if (m_HasTintColor) {
+        m_TintColor = convertVector3(parameters.hairTintColor);
+    }
+}
+
 void OpenGLShapeMaterial::setupUniforms(
     QOpenGLShaderProgram* program,
     const ShaderManager::ShaderType shaderType
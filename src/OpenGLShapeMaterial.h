@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Fo4Material.h"
 #include "ShaderManager.h"
 
 #include <QColor>
@@ -23,6 +24,8 @@ struct OpenGLShapeTextureFeatureFlags {
 class OpenGLShapeMaterial {
 public:
     void apply(nifly::NiShader* shader, bool isPBR);
+    // Replaces the NIF shader values with those of the shape's BGSM/BGEM, as the game does.
+    void applyFo4Material(const Fo4Material::Material& material);
     void setupUniforms(QOpenGLShaderProgram* program, ShaderManager::ShaderType shaderType) const;
 
     [[nodiscard]] OpenGLShapeTextureFeatureFlags textureFeatureFlags() const noexcept {
@@ -97,10 +97,15 @@ void OpenGLShapeTextures::load(
         return;
     }
 
+    for (const auto& descriptor : m_SlotDescriptors) {
+        m_FailedLoadFallbacks[descriptor.slot] = descriptor.textureSetFallback;
+    }
+
     const auto loadedFo4Material = shaderType
                                    == ShaderManager::FO4Default
                                    && loadFo4MaterialTextures(shader, textureManager);
     if (loadedFo4Material) {
+        preparePendingTextures(textureManager);
         return;
     }
 
@@ -116,6 +121,7 @@ void OpenGLShapeTextures::load(
     if (isPBR) {
         ensurePBRTextureDefaults(textureManager);
     }
+    preparePendingTextures(textureManager);
 }
 
 void OpenGLShapeTextures::useDefaultTextures(TextureManager* textureManager) {
@@ -133,20 +139,27 @@ void OpenGLShapeTextures::setupUniforms(
         }
     }
 
+    std::array<PreviewTexture*, TextureSlotCount> textures {};
+    auto loadedTextures = m_LoadedTextures;
+    for (std::size_t slot = 0; slot < textures.size(); ++slot) {
+        textures[slot] = boundTexture(slot);
+        loadedTextures[slot] = loadedTextures[slot] && m_Textures[slot] && m_Textures[slot]->isReady();
+    }
+
     for (const auto& descriptor : m_SlotDescriptors) {
         for (std::size_t i = 0; i < descriptor.featureUniformCount; ++i) {
             const auto& feature = descriptor.featureUniforms[i];
             program->setUniformValue(
                 feature.name,
-                textureFeatureEnabled(m_Textures, m_LoadedTextures, materialFlags, descriptor, feature)
+                textureFeatureEnabled(textures, loadedTextures, materialFlags, descriptor, feature)
             );
         }
     }
 
     bindTextures();
 
-    program->setUniformValue("hasSourceTexture", m_HasSourceTexture && m_Textures[BaseMap] != nullptr);
-    program->setUniformValue("hasGreyscaleMap", m_HasGreyscaleMap && m_Textures[GreyscaleMap] != nullptr);
+    program->setUniformValue("hasSourceTexture", m_HasSourceTexture && textures[BaseMap] != nullptr);
+    program->setUniformValue("hasGreyscaleMap", m_HasGreyscaleMap && textures[GreyscaleMap] != nullptr);
 }
 
 void OpenGLShapeTextures::loadEffectShaderTextures(
@@ -172,6 +185,7 @@ void OpenGLShapeTextures::loadEffectShaderTextures(
         );
         m_Textures[slot] = texture;
         m_LoadedTextures[slot] = loadedTexture;
+        m_FailedLoadFallbacks[slot] = fallback.failedLoad;
     };
 
     assignEffectTexture(BaseMap, sourceTexture);
@@ -283,10 +297,37 @@ void OpenGLShapeTextures::ensurePBRTextureDefaults(TextureManager* textureManage
     }
 }
 
+void OpenGLShapeTextures::preparePendingTextures(TextureManager* textureManager) {
+    for (std::size_t slot = 0; slot < m_Textures.size(); ++slot) {
+        if (!m_Textures[slot] || m_Textures[slot]->isReady()) {
+            continue;
+        }
+
+        m_PlaceholderTextures[slot] = slot == NormalMap ? textureManager->getFlatNormalTexture()
+                                                        : textureManager->getWhiteTexture();
+        m_FailedTextures[slot] = fallbackTexture(textureManager, m_FailedLoadFallbacks[slot]);
+    }
+}
+
+PreviewTexture* OpenGLShapeTextures::boundTexture(const std::size_t textureSlot) const {
+    auto* const texture = m_Textures[textureSlot];
+    if (!texture) {
+        return nullptr;
+    }
+
+    switch (texture->state()) {
+        case PreviewTexture::State::Ready:   return texture;
+        case PreviewTexture::State::Pending: return m_PlaceholderTextures[textureSlot];
+        case PreviewTexture::State::Failed:  return m_FailedTextures[textureSlot];
+    }
+
+    return nullptr;
+}
+
 void OpenGLShapeTextures::bindTextures() const {
     for (std::size_t i = 0; i < m_Textures.size(); i++) {
-        if (m_Textures[i]) {
-            m_Textures[i]->bind(static_cast<int>(i + 1));
+        if (auto* const texture = boundTexture(i)) {
+            texture->bind(static_cast<int>(i + 1));
         }
     }
 }
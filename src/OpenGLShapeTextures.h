@@ -46,10 +46,16 @@ private:
     void loadTextureSetTextures(nifly::NifFile* nifFile, nifly::NiShader* shader, TextureManager* textureManager);
     void assignMissingTexture(TextureManager* textureManager, std::size_t textureSlot);
     void ensurePBRTextureDefaults(TextureManager* textureManager);
+    void preparePendingTextures(TextureManager* textureManager);
+    [[nodiscard]] PreviewTexture* boundTexture(std::size_t textureSlot) const;
     void bindTextures() const;
 
     TextureSlotDescriptorList m_SlotDescriptors {};
     std::array<PreviewTexture*, TextureSlotCount> m_Textures {nullptr};
+    // Textures still loading bind a neutral placeholder, and the slot's failure fallback if the load fails.
+    std::array<PreviewTexture*, TextureSlotCount> m_PlaceholderTextures {nullptr};
+    std::array<PreviewTexture*, TextureSlotCount> m_FailedTextures {nullptr};
+    std::array<TextureFallback, TextureSlotCount> m_FailedLoadFallbacks {};
     std::array<bool, TextureSlotCount> m_LoadedTextures {};
     bool m_HasSourceTexture = false;
     bool m_HasGreyscaleMap = false;
@@ -1,14 +1,134 @@
 #include "PreviewNif.h"
+#include "ArchiveAccess.h"
+#include "ArchiveIndex.h"
+#include "ArchiveIndexer.h"
+#include "ArchivePool.h"
 #include "Camera.h"
+#include "DdsTextures.h"
+#include "DecodedTextureCache.h"
+#include "DirectorySnapshots.h"
+#include "Fo4MaterialCache.h"
+#include "MissingDataFiles.h"
+#include "MoDataPaths.h"
+#include "NifDataCache.h"
+#include "NifFileCache.h"
 #include "NifPreviewSource.h"
 #include "NifPreviewWidget.h"
+#include "PreviewPaneController.h"
+#include "TextureManager.h"
 
 #include <QDebug>
+#include <QDir>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ranges>
+#include <uibase/imoinfo.h>
+#include <uibase/imodinterface.h>
+#include <uibase/imodlist.h>
+#include <uibase/ipluginlist.h>
+#include <uibase/iprofile.h>
 #include <utility>
 
+namespace {
+constexpr auto BackgroundIndexingSetting = "background_archive_indexing";
+constexpr auto NativeArchiveReaderSetting = "native_archive_reader";
+constexpr auto MaxTextureSizeSetting = "max_texture_size";
+constexpr auto DecodedTextureCacheSetting = "decoded_texture_cache_mb";
+}
+
+PreviewNif::~PreviewNif() {
+    ArchiveIndexer::cancel();
+    ArchiveIndexer::waitForPendingJobs();
+    PreviewPaneController::waitForPendingLoads();
+    TextureManager::waitForPendingLoads();
+    ArchiveIndex::instance().save();
+    DecodedTextureCache::instance().clear();
+    Fo4MaterialCache::instance().clear();
+    NifDataCache::instance().clear();
+    NifFileCache::instance().clear();
+    ArchivePool::instance().clear();
+}
+
 bool PreviewNif::init(MOBase::IOrganizer* moInfo) {
     m_MOInfo = moInfo;
+    if (!moInfo) {
+        return true;
+    }
+
+    // Builds without libbsarch always use the native reader.
+    ArchiveAccess::setBackend(
+        moInfo->pluginSetting(name(), NativeArchiveReaderSetting).toBool() ? ArchiveAccess::Backend::Native
+                                                                          : ArchiveAccess::Backend::Libbsarch
+    );
+    const auto maxTextureSize = moInfo->pluginSetting(name(), MaxTextureSizeSetting).toInt();
+    DdsTextures::setMaxDimension(static_cast<std::uint32_t>(std::max(maxTextureSize, 0)));
+    const auto decodedCacheMegabytes = moInfo->pluginSetting(name(), DecodedTextureCacheSetting).toInt();
+    DecodedTextureCache::instance().setMemoryBudget(
+        static_cast<std::size_t>(std::max(decodedCacheMegabytes, 0)) * 1024 * 1024
+    );
+
+    // Loads the persisted archive index; only archives changed since the last session are rescanned.
+    ArchiveIndex::instance().reset(moInfo->profilePath());
+    startBackgroundIndexing();
+    moInfo->onProfileChanged([this](MOBase::IProfile*, MOBase::IProfile* profile) {
+        MissingDataFiles::instance().clear();
+        Fo4MaterialCache::instance().clear();
+        MoDataPaths::invalidateArchiveLists();
+        DirectorySnapshots::instance().clear();
+        ArchiveIndexer::cancel();
+        ArchiveIndex::instance().reset(profile ? profile->absolutePath() : QString());
+        startBackgroundIndexing();
+    });
+
+    // Reinstalled or removed mods drop their archives so the next lookup rescans only that mod.
+    if (auto* const modList = moInfo->modList()) {
+        modList->onModInstalled([](MOBase::IModInterface* mod) {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+            DirectorySnapshots::instance().clear();
+            if (mod) {
+                MoDataPaths::invalidateModArchives(mod->name());
+                ArchiveIndex::instance().removeOwner(mod->name());
+                ArchivePool::instance().removeDirectory(mod->absolutePath());
+            }
+        });
+        modList->onModRemoved([moInfo](const QString& modName) {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+            MoDataPaths::invalidateModArchives(modName);
+            DirectorySnapshots::instance().clear();
+            ArchiveIndex::instance().removeOwner(modName);
+            ArchivePool::instance().removeDirectory(QDir(moInfo->modsPath()).filePath(modName));
+        });
+        // Enabling, disabling or reordering mods changes which files exist and who wins them.
+        modList->onModStateChanged([](const std::map<QString, MOBase::IModList::ModStates>& states) {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+            for (const auto& modName : states | std::views::keys) {
+                MoDataPaths::invalidateModArchives(modName);
+            }
+        });
+        modList->onModMoved([](const QString&, int, int) {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+        });
+    }
+    if (auto* const pluginList = moInfo->pluginList()) {
+        // MO2 refreshes after files change on disk, which can add or remove archives anywhere.
+        pluginList->onRefreshed([] {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+            MoDataPaths::invalidateArchiveLists();
+            DirectorySnapshots::instance().clear();
+            ArchivePool::instance().clear();
+        });
+        pluginList->onPluginStateChanged([](const std::map<QString, MOBase::IPluginList::PluginStates>&) {
+            MissingDataFiles::instance().clear();
+            Fo4MaterialCache::instance().clear();
+        });
+    }
     return true;
 }
 
@@ -29,7 +149,28 @@ MOBase::VersionInfo PreviewNif::version() const {
 }
 
 QList<MOBase::PluginSetting> PreviewNif::settings() const {
-    return {};
+    return {
+        MOBase::PluginSetting(
+            BackgroundIndexingSetting,
+            tr("Index mod and game archives in the background when the plugin loads or the profile changes"),
+            true
+        ),
+        MOBase::PluginSetting(
+            NativeArchiveReaderSetting,
+            tr("Read BSA/BA2 archives with the built-in memory-mapped reader instead of libbsarch"),
+            false
+        ),
+        MOBase::PluginSetting(
+            MaxTextureSizeSetting,
+            tr("Largest texture width or height to upload; bigger mip levels are skipped (0 uploads all levels)"),
+            2048
+        ),
+        MOBase::PluginSetting(
+            DecodedTextureCacheSetting,
+            tr("Megabytes of texture data kept in memory so reopened previews skip reading and parsing (0 disables)"),
+            256
+        ),
+    };
 }
 
 bool PreviewNif::enabledByDefault() const {
@@ -62,6 +203,12 @@ QWidget* PreviewNif::genDataPreview(const QByteArray& fileData, const QString& f
     return new NifPreviewWidget(std::move(sourceSet), m_MOInfo, sharedCamera());
 }
 
+void PreviewNif::startBackgroundIndexing() const {
+    if (m_MOInfo && m_MOInfo->pluginSetting(name(), BackgroundIndexingSetting).toBool()) {
+        ArchiveIndexer::start(m_MOInfo);
+    }
+}
+
 QSharedPointer<Camera> PreviewNif::sharedCamera() const {
     auto camera = m_SharedCamera.toStrongRef();
     if (camera.isNull()) {
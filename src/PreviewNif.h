@@ -13,6 +13,11 @@ class PreviewNif final : public MOBase::IPluginPreview {
 
 public:
     PreviewNif() = default;
+    ~PreviewNif() override;
+    PreviewNif(const PreviewNif&) = delete;
+    PreviewNif(PreviewNif&&) = delete;
+    PreviewNif& operator=(const PreviewNif&) = delete;
+    PreviewNif& operator=(PreviewNif&&) = delete;
 
     // IPlugin Interface
 
@@ -36,6 +41,7 @@ public:
     ) const override;
 
 private:
+    void startBackgroundIndexing() const;
     [[nodiscard]] QSharedPointer<Camera> sharedCamera() const;
 
     MOBase::IOrganizer* m_MOInfo {};
@@ -1,10 +1,16 @@
 #include "PreviewPaneController.h"
+#include "NifFileCache.h"
 
 #include <QDebug>
 #include <QFileInfo>
+#include <QMetaObject>
+#include <QObject>
+#include <QThreadPool>
 
 #include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <mutex>
 #include <utility>
 
 namespace {
@@ -19,12 +25,50 @@ QString previewTitleFor(const NifPreviewProvider& provider) {
 
     return title;
 }
+
+QThreadPool& nifThreadPool() {
+    static QThreadPool pool;
+    return pool;
+}
+
+std::shared_ptr<nifly::NifFile> loadAndCacheNifProvider(const NifPreviewProvider& provider, const QString& cacheKey) {
+    auto nifFile = loadNifProvider(provider);
+    if (nifFile) {
+        NifFileCache::instance().insert(cacheKey, nifFile, NifFileCache::estimateBytes(nifFile.get()));
+    }
+    return nifFile;
+}
 } // namespace
 
+// Shared with worker tasks. A load is cancelled by bumping the generation: queued tasks
+// skip parsing and finished ones drop their result. Cleared when the controller dies.
+struct PreviewPaneController::LoadState {
+    std::mutex mutex;
+    QObject* receiver = nullptr;
+    std::uint64_t generation = 0;
+
+    [[nodiscard]] bool isCurrent(const std::uint64_t taskGeneration) {
+        const std::scoped_lock lock(mutex);
+        return receiver && taskGeneration == generation;
+    }
+};
+
 PreviewPaneController::PreviewPaneController(MOBase::IOrganizer* organizer)
-    : m_Organizer(organizer) {}
+    : m_Organizer(organizer)
+    , m_LoadState(std::make_shared<LoadState>()) {}
+
+PreviewPaneController::~PreviewPaneController() {
+    const std::scoped_lock lock(m_LoadState->mutex);
+    m_LoadState->receiver = nullptr;
+    ++m_LoadState->generation;
+}
+
+void PreviewPaneController::waitForPendingLoads() {
+    nifThreadPool().waitForDone();
+}
 
 void PreviewPaneController::setProviders(QVector<NifPreviewProvider> providers, const int currentIndex) {
+    cancelLoad();
     m_Providers = std::move(providers);
     const auto lastProviderIndex = static_cast<int>(m_Providers.size()) - 1;
     m_CurrentProviderIndex = std::clamp(currentIndex, 0, std::max(0, lastProviderIndex));
@@ -74,35 +118,104 @@ bool PreviewPaneController::selectRelativeTextureSource(const int offset) {
     return selectTextureSource((m_CurrentTextureSourceIndex + offset + providerCount) % providerCount);
 }
 
-PreviewPaneLoadResult PreviewPaneController::loadCurrentProvider() {
+bool PreviewPaneController::refreshTextureSources() {
+    if (!m_CurrentNifFile) {
+        return false;
+    }
+
+    TextureSourceSet textureSourceSet;
+    try {
+        textureSourceSet = TextureSourceResolver::resolve(m_Organizer, m_CurrentNifFile.get());
+    } catch (const std::exception& e) {
+        qWarning("Failed to refresh texture sources: %s", e.what());
+        return false;
+    } catch (...) {
+        qWarning("Failed to refresh texture sources: unknown exception");
+        return false;
+    }
+
+    const auto sameProviders = std::ranges::equal(
+        textureSourceSet.providers,
+        m_TextureSourceSet.providers,
+        {},
+        &TextureSourceProvider::displayName,
+        &TextureSourceProvider::displayName
+    );
+    if (sameProviders) {
+        return false;
+    }
+
+    const auto currentKey = textureProviderKey(currentTextureSourceProvider());
+    const auto current = std::ranges::find(textureSourceSet.providers, currentKey, [](const auto& provider) {
+        return textureProviderKey(provider);
+    });
+    m_CurrentTextureSourceIndex = current != textureSourceSet.providers.end()
+        ? static_cast<int>(current - textureSourceSet.providers.begin())
+        : 0;
+    m_TextureSourceSet = std::move(textureSourceSet);
+    return true;
+}
+
+PreviewPaneLoadResult PreviewPaneController::loadCurrentProvider(
+    QObject* receiver,
+    std::function<void(const PreviewPaneLoadResult&)> onLoaded
+) {
+    cancelLoad();
+    resetLoadedData();
     if (m_CurrentProviderIndex < 0 || m_CurrentProviderIndex >= m_Providers.size()) {
-        resetLoadedData();
         return {.status = PreviewPaneLoadStatus::NoProvider};
     }
 
     const auto& provider = m_Providers[m_CurrentProviderIndex];
-    const auto title = previewTitleFor(provider);
+    const auto cacheKey = nifProviderCacheKey(provider);
+    if (auto nifFile = NifFileCache::instance().find(cacheKey)) {
+        return finishLoad(provider, std::move(nifFile));
+    }
 
-    try {
-        const auto nifFile = loadNifProvider(provider);
-        if (!nifFile) {
-            qWarning("Failed to load NIF preview provider '%s'", qUtf8Printable(provider.displayName));
-            resetLoadedData();
-            return {.status = PreviewPaneLoadStatus::Failed, .title = title};
+    std::uint64_t generation = 0;
+    {
+        const std::scoped_lock lock(m_LoadState->mutex);
+        m_LoadState->receiver = receiver;
+        generation = m_LoadState->generation;
+    }
+
+    // A superseded parse cannot be interrupted, so a second thread lets the newest one start.
+    nifThreadPool().setMaxThreadCount(2);
+    nifThreadPool().start([this, state = m_LoadState, generation, provider, cacheKey, onLoaded = std::move(onLoaded)] {
+        if (!state->isCurrent(generation)) {
+            return;
         }
 
-        m_CurrentNifFile = nifFile;
-        m_TextureSourceSet = TextureSourceResolver::resolve(m_Organizer, nifFile.get());
-        m_CurrentTextureSourceIndex = 0;
-        return {.status = PreviewPaneLoadStatus::Loaded, .title = title, .statsText = makeNifStatsText(nifFile.get())};
-    } catch (const std::exception& e) {
-        qWarning("Failed to load NIF preview provider '%s': %s", qUtf8Printable(provider.displayName), e.what());
-    } catch (...) {
-        qWarning("Failed to load NIF preview provider '%s': unknown exception", qUtf8Printable(provider.displayName));
-    }
+        std::shared_ptr<nifly::NifFile> nifFile;
+        try {
+            nifFile = loadAndCacheNifProvider(provider, cacheKey);
+        } catch (const std::exception& e) {
+            qWarning("Failed to load NIF preview provider '%s': %s", qUtf8Printable(provider.displayName), e.what());
+        } catch (...) {
+            qWarning(
+                "Failed to load NIF preview provider '%s': unknown exception",
+                qUtf8Printable(provider.displayName)
+            );
+        }
 
-    resetLoadedData();
-    return {.status = PreviewPaneLoadStatus::Failed, .title = title};
+        const std::scoped_lock lock(state->mutex);
+        if (!state->receiver || generation != state->generation) {
+            return;
+        }
+
+        // Queued calls die with the receiver, and the receiver owns this controller.
+        QMetaObject::invokeMethod(
+            state->receiver,
+            [this, state, generation, provider, nifFile = std::move(nifFile), onLoaded] {
+                if (state->isCurrent(generation)) {
+                    onLoaded(finishLoad(provider, nifFile));
+                }
+            },
+            Qt::QueuedConnection
+        );
+    });
+
+    return {.status = PreviewPaneLoadStatus::Loading, .title = previewTitleFor(provider)};
 }
 
 TextureSourceProvider PreviewPaneController::currentTextureSourceProvider() const {
@@ -113,6 +226,31 @@ TextureSourceProvider PreviewPaneController::currentTextureSourceProvider() cons
     return m_TextureSourceSet.providers[m_CurrentTextureSourceIndex];
 }
 
+void PreviewPaneController::cancelLoad() {
+    const std::scoped_lock lock(m_LoadState->mutex);
+    ++m_LoadState->generation;
+}
+
+PreviewPaneLoadResult PreviewPaneController::finishLoad(
+    const NifPreviewProvider& provider,
+    std::shared_ptr<nifly::NifFile> nifFile
+) {
+    const auto title = previewTitleFor(provider);
+    if (!nifFile) {
+        qWarning("Failed to load NIF preview provider '%s'", qUtf8Printable(provider.displayName));
+        return {.status = PreviewPaneLoadStatus::Failed, .title = title};
+    }
+
+    // Texture sources stay empty, which previews with Auto, until refreshTextureSources().
+    resetLoadedData();
+    m_CurrentNifFile = std::move(nifFile);
+    return {
+        .status = PreviewPaneLoadStatus::Loaded,
+        .title = title,
+        .statsText = makeNifStatsText(m_CurrentNifFile.get()),
+    };
+}
+
 void PreviewPaneController::resetLoadedData() {
     m_TextureSourceSet = {};
     m_CurrentTextureSourceIndex = 0;
@@ -3,14 +3,18 @@
 #include "NifPreviewSource.h"
 #include "TextureSource.h"
 
+#include <functional>
 #include <memory>
 
+class QObject;
+
 namespace MOBase {
 class IOrganizer;
 }
 
 enum class PreviewPaneLoadStatus {
     NoProvider,
+    Loading,
     Failed,
     Loaded
 };
@@ -24,13 +28,30 @@ struct PreviewPaneLoadResult {
 class PreviewPaneController final {
 public:
     explicit PreviewPaneController(MOBase::IOrganizer* organizer);
+    ~PreviewPaneController();
+    PreviewPaneController(const PreviewPaneController&) = delete;
+    PreviewPaneController& operator=(const PreviewPaneController&) = delete;
+
+    static void waitForPendingLoads();
 
     void setProviders(QVector<NifPreviewProvider> providers, int currentIndex);
     bool selectProvider(int index);
     bool selectRelativeProvider(int offset);
     bool selectTextureSource(int index);
     bool selectRelativeTextureSource(int offset);
-    PreviewPaneLoadResult loadCurrentProvider();
+    // Resolves the loaded NIF's texture sources, once it is shown and again when the archive
+    // index grew. Keeps the selected source while it is still listed; returns false when the
+    // list is unchanged.
+    bool refreshTextureSources();
+    // Returns Loaded right away for a NifFileCache hit, or NoProvider when there is nothing to
+    // load. Otherwise parses the current provider on a worker thread and returns Loading; a
+    // newer request cancels older ones and only the latest calls onLoaded, on receiver's
+    // thread. Either way texture sources are left for refreshTextureSources(), since they use
+    // MO2 and read materials. receiver must own the controller.
+    PreviewPaneLoadResult loadCurrentProvider(
+        QObject* receiver,
+        std::function<void(const PreviewPaneLoadResult&)> onLoaded
+    );
 
     [[nodiscard]] const QVector<NifPreviewProvider>& providers() const {
         return m_Providers;
@@ -55,6 +76,13 @@ public:
     [[nodiscard]] TextureSourceProvider currentTextureSourceProvider() const;
 
 private:
+    struct LoadState;
+
+    void cancelLoad();
+    [[nodiscard]] PreviewPaneLoadResult finishLoad(
+        const NifPreviewProvider& provider,
+        std::shared_ptr<nifly::NifFile> nifFile
+    );
     void resetLoadedData();
 
     MOBase::IOrganizer* m_Organizer = nullptr;
@@ -63,4 +91,5 @@ private:
     TextureSourceSet m_TextureSourceSet;
     int m_CurrentTextureSourceIndex = 0;
     std::shared_ptr<nifly::NifFile> m_CurrentNifFile;
+    std::shared_ptr<LoadState> m_LoadState;
 };
@@ -1,10 +1,16 @@
 #include "PreviewTexture.h"
 
+#include <utility>
+
+PreviewTexture::PreviewTexture()
+    : m_State(State::Pending) {}
+
 PreviewTexture::PreviewTexture(QOpenGLTexture* texture)
     : m_QtTexture(texture) {}
 
-PreviewTexture::PreviewTexture(const GLuint textureId, const GLenum target)
-    : m_RawTexture(textureId, target) {}
+PreviewTexture::PreviewTexture(const GLuint textureId, const GLenum target, const std::size_t byteSize)
+    : m_RawTexture(textureId, target)
+    , m_ByteSize(byteSize) {}
 
 PreviewTexture::~PreviewTexture() = default;
 
@@ -21,3 +27,15 @@ void PreviewTexture::destroyWithCurrentContext() {
     m_QtTexture.destroyWithCurrentContext();
     m_RawTexture.destroyWithCurrentContext();
 }
+
+void PreviewTexture::resolve(std::unique_ptr<PreviewTexture> texture) {
+    if (!texture || !texture->isReady()) {
+        m_State = State::Failed;
+        return;
+    }
+
+    m_QtTexture = std::move(texture->m_QtTexture);
+    m_RawTexture = std::move(texture->m_RawTexture);
+    m_ByteSize = texture->m_ByteSize;
+    m_State = State::Ready;
+}
@@ -2,10 +2,21 @@
 
 #include "OpenGLResources.h"
 
+#include <cstddef>
+#include <memory>
+
 class PreviewTexture {
 public:
+    enum class State {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    // A pending texture binds nothing until resolve() hands it the uploaded texture.
+    PreviewTexture();
     explicit PreviewTexture(QOpenGLTexture* texture);
-    PreviewTexture(GLuint textureId, GLenum target);
+    PreviewTexture(GLuint textureId, GLenum target, std::size_t byteSize = 0);
     ~PreviewTexture();
     PreviewTexture(const PreviewTexture&) = delete;
     PreviewTexture(PreviewTexture&&) = delete;
@@ -14,8 +25,25 @@ public:
 
     void bind(int textureUnit) const;
     void destroyWithCurrentContext();
+    void resolve(std::unique_ptr<PreviewTexture> texture);
+
+    [[nodiscard]] State state() const noexcept {
+        return m_State;
+    }
+    [[nodiscard]] bool isReady() const noexcept {
+        return m_State == State::Ready;
+    }
+    // Video memory used by the uploaded levels; zero for textures not created from a DDS.
+    [[nodiscard]] std::size_t byteSize() const noexcept {
+        return m_ByteSize;
+    }
+    [[nodiscard]] const OpenGLTextureResource& rawTexture() const noexcept {
+        return m_RawTexture;
+    }
 
 private:
+    State m_State = State::Ready;
     QtOpenGLTextureResource m_QtTexture;
     OpenGLTextureResource m_RawTexture;
+    std::size_t m_ByteSize = 0;
 };
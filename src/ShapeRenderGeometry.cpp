@@ -1,4 +1,5 @@
 #include "ShapeRenderGeometry.h"
+#include "NifShaderFlags.h"
 #include "NifTransforms.h"
 
 #include <QDebug>
@@ -8,6 +9,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <exception>
 #include <string>
 #include <unordered_map>
 
@@ -444,6 +446,22 @@ void validateShapeGeometry(nifly::NiShape* shape) {
     }
 }
 
+void validateNifGeometry(nifly::NifFile* nifFile) {
+    for (auto* const shape : nifFile->GetShapes()) {
+        if (!shape || shape->flags & TriShape::Hidden) {
+            continue;
+        }
+
+        try {
+            validateShapeGeometry(shape);
+        } catch (const std::exception& e) {
+            qWarning("Failed to validate NIF shape '%s': %s", shapeName(shape).c_str(), e.what());
+        } catch (...) {
+            qWarning("Failed to validate NIF shape '%s': unknown exception", shapeName(shape).c_str());
+        }
+    }
+}
+
 ShapeRenderGeometry prepareShapeRenderGeometry(nifly::NifFile* nifFile, nifly::NiShape* shape) {
     ShapeRenderGeometry geometry;
     geometry.rawPositions = nifFile->GetVertsForShape(shape);
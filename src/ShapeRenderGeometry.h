@@ -32,4 +32,6 @@ struct ShapeRenderGeometry {
 };
 
 void validateShapeGeometry(nifly::NiShape* shape);
+// Validates every visible shape once at load, so rendering never mutates a shared NifFile.
+void validateNifGeometry(nifly::NifFile* nifFile);
 [[nodiscard]] ShapeRenderGeometry prepareShapeRenderGeometry(nifly::NifFile* nifFile, nifly::NiShape* shape);
@@ -0,0 +1,62 @@
+#include "SpanStream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+SpanStreamBuf::SpanStreamBuf(const std::span<const char> bytes) {
+    // The get area is never written through; std::streambuf just has no const interface.
+    auto* const begin = const_cast<char*>(bytes.data());
+    setg(begin, begin, begin + bytes.size());
+}
+
+SpanStreamBuf::pos_type SpanStreamBuf::seekoff(
+    const off_type offset,
+    const std::ios_base::seekdir direction,
+    const std::ios_base::openmode which
+) {
+    if ((which & std::ios_base::in) == 0) {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+    if (direction == std::ios_base::cur) {
+        base = gptr() - eback();
+    } else if (direction == std::ios_base::end) {
+        base = egptr() - eback();
+    }
+
+    const auto target = base + offset;
+    if (target < 0 || target > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + target, egptr());
+    return pos_type(target);
+}
+
+SpanStreamBuf::pos_type SpanStreamBuf::seekpos(const pos_type position, const std::ios_base::openmode which) {
+    return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+std::streamsize SpanStreamBuf::showmanyc() {
+    const auto available = egptr() - gptr();
+    return available > 0 ? available : -1;
+}
+
+std::streamsize SpanStreamBuf::xsgetn(char_type* const destination, const std::streamsize count) {
+    const auto copied = std::min<std::streamsize>(count, egptr() - gptr());
+    if (copied <= 0) {
+        return 0;
+    }
+
+    std::memcpy(destination, gptr(), static_cast<std::size_t>(copied));
+    setg(eback(), gptr() + copied, egptr());
+    return copied;
+}
+
+SpanStream::SpanStream(const std::span<const char> bytes)
+    : std::istream(nullptr)
+    , m_Buffer(bytes) {
+    rdbuf(&m_Buffer);
+}
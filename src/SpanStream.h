@@ -0,0 +1,27 @@
+#pragma once
+
+#include <istream>
+#include <span>
+#include <streambuf>
+
+// Read-only stream over bytes owned elsewhere, so parsers that take a std::istream can
+// read straight from a file mapping or archive buffer. The bytes must outlive the stream.
+class SpanStreamBuf final : public std::streambuf {
+public:
+    explicit SpanStreamBuf(std::span<const char> bytes);
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+    std::streamsize showmanyc() override;
+    // One copy per read call; nifly reads vertex and triangle arrays in single calls.
+    std::streamsize xsgetn(char_type* destination, std::streamsize count) override;
+};
+
+class SpanStream final : public std::istream {
+public:
+    explicit SpanStream(std::span<const char> bytes);
+
+private:
+    SpanStreamBuf m_Buffer;
+};
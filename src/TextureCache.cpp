@@ -2,13 +2,13 @@
 #include "PreviewTexture.h"
 #include "TextureUpload.h"
 
-#include <QString>
-
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 void TextureCache::cleanup() {
-    for (auto& [key, texture] : m_Textures) {
-        destroyTexture(texture);
+    for (auto& [key, entry] : m_Textures) {
+        destroyTexture(entry.texture);
     }
     m_Textures.clear();
 
@@ -18,24 +18,73 @@ void TextureCache::cleanup() {
     destroyTexture(m_FlatNormalTexture);
 }
 
-bool TextureCache::containsTexture(const QString& texturePath) const {
-    return m_Textures.contains(cacheKey(texturePath));
+bool TextureCache::containsTexture(const DataPathKey& key) const {
+    return m_Textures.contains(key);
 }
 
-PreviewTexture* TextureCache::texture(const QString& texturePath) const {
-    if (const auto it = m_Textures.find(cacheKey(texturePath)); it != m_Textures.end()) {
-        return it->second.get();
+PreviewTexture* TextureCache::texture(const DataPathKey& key) const {
+    if (const auto it = m_Textures.find(key); it != m_Textures.end()) {
+        return it->second.texture.get();
     }
 
     return nullptr;
 }
 
-PreviewTexture* TextureCache::storeTexture(const QString& texturePath, std::unique_ptr<PreviewTexture> texture) {
+PreviewTexture* TextureCache::storeTexture(const DataPathKey& key, std::unique_ptr<PreviewTexture> texture) {
     auto* const texturePtr = texture.get();
-    m_Textures[cacheKey(texturePath)] = std::move(texture);
+    auto& entry = m_Textures[key];
+    entry.texture = std::move(texture);
+    entry.lastUse = ++m_UseCounter;
     return texturePtr;
 }
 
+void TextureCache::acquire(const DataPathKey& key) {
+    if (const auto it = m_Textures.find(key); it != m_Textures.end()) {
+        ++it->second.users;
+        it->second.lastUse = ++m_UseCounter;
+    }
+}
+
+void TextureCache::release(const DataPathKey& key) {
+    const auto it = m_Textures.find(key);
+    if (it == m_Textures.end() || it->second.users == 0) {
+        return;
+    }
+
+    auto& entry = it->second;
+    entry.lastUse = ++m_UseCounter;
+    if (--entry.users == 0 && (!entry.texture || entry.texture->state() == PreviewTexture::State::Failed)) {
+        m_Textures.erase(it);
+    }
+}
+
+void TextureCache::trim(const std::size_t unusedBytesBudget) {
+    std::vector<decltype(m_Textures)::iterator> unused;
+    std::size_t unusedBytes = 0;
+    for (auto it = m_Textures.begin(); it != m_Textures.end(); ++it) {
+        const auto& texture = it->second.texture;
+        if (it->second.users == 0 && texture && texture->isReady()) {
+            unused.push_back(it);
+            unusedBytes += texture->byteSize();
+        }
+    }
+    if (unusedBytes <= unusedBytesBudget) {
+        return;
+    }
+
+    std::sort(unused.begin(), unused.end(), [](const auto& left, const auto& right) {
+        return left->second.lastUse < right->second.lastUse;
+    });
+    for (const auto& it : unused) {
+        if (unusedBytes <= unusedBytesBudget) {
+            break;
+        }
+        unusedBytes -= it->second.texture->byteSize();
+        destroyTexture(it->second.texture);
+        m_Textures.erase(it);
+    }
+}
+
 PreviewTexture* TextureCache::getErrorTexture() {
     return getFallbackTexture(m_ErrorTexture, {1.0f, 0.0f, 1.0f, 1.0f});
 }
@@ -52,10 +101,6 @@ PreviewTexture* TextureCache::getFlatNormalTexture() {
     return getFallbackTexture(m_FlatNormalTexture, {0.5f, 0.5f, 1.0f, 1.0f});
 }
 
-std::wstring TextureCache::cacheKey(const QString& texturePath) {
-    return texturePath.toLower().toStdWString();
-}
-
 void TextureCache::destroyTexture(std::unique_ptr<PreviewTexture>& texture) {
     if (texture) {
         texture->destroyWithCurrentContext();
@@ -1,22 +1,30 @@
 #pragma once
 
+#include "DataPathKey.h"
 #include "PreviewTexture.h"
 
 #include <QVector4D>
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <string>
-
-class QString;
+#include <unordered_map>
 
+// Textures stay cached after their last user releases them; trim() destroys the least
+// recently used of those once they exceed a budget.
 class TextureCache {
 public:
     void cleanup();
 
-    [[nodiscard]] bool containsTexture(const QString& texturePath) const;
-    [[nodiscard]] PreviewTexture* texture(const QString& texturePath) const;
-    PreviewTexture* storeTexture(const QString& texturePath, std::unique_ptr<PreviewTexture> texture);
+    [[nodiscard]] bool containsTexture(const DataPathKey& key) const;
+    [[nodiscard]] PreviewTexture* texture(const DataPathKey& key) const;
+    PreviewTexture* storeTexture(const DataPathKey& key, std::unique_ptr<PreviewTexture> texture);
+
+    void acquire(const DataPathKey& key);
+    // Missing and failed textures are dropped with their last user so the next request retries them.
+    void release(const DataPathKey& key);
+    // Needs a current context of the share group that owns the textures.
+    void trim(std::size_t unusedBytesBudget);
 
     PreviewTexture* getErrorTexture();
     PreviewTexture* getBlackTexture();
@@ -24,11 +32,17 @@ public:
     PreviewTexture* getFlatNormalTexture();
 
 private:
-    [[nodiscard]] static std::wstring cacheKey(const QString& texturePath);
+    struct Entry {
+        std::unique_ptr<PreviewTexture> texture;
+        int users = 0;
+        std::uint64_t lastUse = 0;
+    };
+
     static void destroyTexture(std::unique_ptr<PreviewTexture>& texture);
     static PreviewTexture* getFallbackTexture(std::unique_ptr<PreviewTexture>& texture, QVector4D color);
 
-    std::map<std::wstring, std::unique_ptr<PreviewTexture>> m_Textures;
+    std::unordered_map<DataPathKey, Entry> m_Textures;
+    std::uint64_t m_UseCounter = 0;
     std::unique_ptr<PreviewTexture> m_ErrorTexture;
     std::unique_ptr<PreviewTexture> m_BlackTexture;
     std::unique_ptr<PreviewTexture> m_WhiteTexture;
@@ -1,28 +1,47 @@
 #include "TextureLoader.h"
 #include "ArchiveAccess.h"
+#include "ArchiveIndex.h"
+#include "ArchiveIndexer.h"
 #include "DdsTextures.h"
+#include "DirectorySnapshots.h"
+#include "MappedFile.h"
+#include "MissingDataFiles.h"
 #include "MoDataPaths.h"
 #include "PreviewNif.h"
 #include "PreviewTexture.h"
 #include "TextureUpload.h"
 
-#include <libbsarch/bs_archive.h>
-
 #include <QDebug>
 #include <QDir>
-#include <QFile>
-#include <QFileInfo>
 
 #include <cstddef>
 #include <exception>
+#include <span>
 #include <utility>
 
+namespace {
+TextureLoader::Candidate looseCandidate(const QString& loosePath, const bool endsLookup) {
+    return {.loosePath = loosePath, .endsLookup = endsLookup, .owner = {}, .archivePaths = {}, .dataPath = {}};
+}
+
+TextureLoader::Candidate archiveCandidate(
+    const QString& owner,
+    const QStringList& archivePaths,
+    const QString& dataPath
+) {
+    return {.loosePath = {}, .endsLookup = false, .owner = owner, .archivePaths = archivePaths, .dataPath = dataPath};
+}
+} // namespace
+
 TextureLoader::TextureLoader(MOBase::IOrganizer* organizer, TextureSourceProvider textureSource)
     : m_MOInfo {organizer}
     , m_TextureSource {std::move(textureSource)} {}
 
 std::unique_ptr<PreviewTexture> TextureLoader::load(const QString& texturePath) const {
     const auto normalizedPath = normalizeTextureDataPath(texturePath);
+    if (MissingDataFiles::instance().contains(textureProviderKey(m_TextureSource), normalizedPath)) {
+        return nullptr;
+    }
     if (auto texture = tryLoadFromSource(normalizedPath)) {
         return texture;
     }
@@ -30,12 +49,205 @@ std::unique_ptr<PreviewTexture> TextureLoader::load(const QString& texturePath)
     return loadAuto(normalizedPath);
 }
 
-QByteArray TextureLoader::loadDataFile(const QString& dataPath) const {
+ArchiveAccess::ExtractedBytes TextureLoader::loadDataFile(const QString& dataPath) const {
+    auto& missingFiles = MissingDataFiles::instance();
+    const auto sourceKey = textureProviderKey(m_TextureSource);
+    if (missingFiles.contains(sourceKey, dataPath)) {
+        return {};
+    }
+
     if (auto data = tryLoadDataFileFromSource(dataPath); !data.isEmpty()) {
         return data;
     }
 
-    return loadDataFileAuto(dataPath);
+    auto data = loadDataFileAuto(dataPath);
+    if (data.isEmpty()) {
+        missingFiles.insert(sourceKey, dataPath);
+    }
+    return data;
+}
+
+QVector<ArchiveAccess::ExtractedBytes> TextureLoader::loadDataFiles(const QStringList& dataPaths) const {
+    QVector<ArchiveAccess::ExtractedBytes> data(dataPaths.size());
+    QVector<ArchiveAccess::BatchRead> reads;
+    QVector<qsizetype> readFiles;
+    for (qsizetype i = 0; i < dataPaths.size(); ++i) {
+        const auto location = locateDataFile(dataPaths[i]);
+        if (!location.loosePath.isEmpty()) {
+            data[i] = MappedFile::read(location.loosePath);
+        } else if (location.archiveRead) {
+            reads.append(*location.archiveRead);
+            readFiles.append(i);
+        }
+    }
+
+    const auto buffers = ArchiveAccess::extractBatch(reads);
+    for (qsizetype i = 0; i < reads.size(); ++i) {
+        auto& file = data[readFiles[i]];
+        file = buffers[i];
+        if (file.isEmpty()) {
+            file = loadDataFile(dataPaths[readFiles[i]]);
+        }
+    }
+
+    return data;
+}
+
+TextureLoader::Lookup TextureLoader::lookupTexture(const QString& texturePath) const {
+    Lookup lookup {.sourceKey = textureProviderKey(m_TextureSource), .texturePath = texturePath, .candidates = {}};
+    if (texturePath.isEmpty() || !m_MOInfo || MissingDataFiles::instance().contains(lookup.sourceKey, texturePath)) {
+        return lookup;
+    }
+
+    auto& candidates = lookup.candidates;
+    if (m_TextureSource.kind != TextureSourceProviderKind::Auto
+        && textureProviderCoversPath(m_TextureSource, texturePath)) {
+        if (!m_TextureSource.sourcePath.isEmpty()) {
+            for (const auto& path : textureDataPathVariants(texturePath)) {
+                const auto realPath = QDir(m_TextureSource.sourcePath).absoluteFilePath(QDir::cleanPath(path));
+                candidates.append(looseCandidate(realPath, false));
+            }
+        }
+
+        candidates.append(archiveCandidate(sourceArchiveOwner(), m_TextureSource.archivePaths, texturePath));
+    }
+
+    for (const auto& path : textureDataPathVariants(texturePath)) {
+        if (const auto realPath = MoDataPaths::resolveDataPath(m_MOInfo, path); !realPath.isEmpty()) {
+            candidates.append(looseCandidate(realPath, true));
+        }
+    }
+
+    for (const auto& path : textureDataPathVariants(texturePath)) {
+        const auto fileOrigins = m_MOInfo->getFileOrigins(path);
+        if (fileOrigins.empty()) {
+            continue;
+        }
+
+        const auto& modName = fileOrigins.constFirst();
+        if (auto* const mod = m_MOInfo->modList()->getMod(modName)) {
+            candidates.append(archiveCandidate(modName, MoDataPaths::archivePathsFromMod(mod), path));
+        }
+    }
+
+    candidates.append(
+        archiveCandidate(ArchiveIndex::GameOwner, MoDataPaths::archivePathsFromGame(m_MOInfo), texturePath)
+    );
+    return lookup;
+}
+
+QVector<TextureLoader::Location> TextureLoader::resolveLookup(const Lookup& lookup) {
+    QVector<Location> locations;
+    for (const auto& candidate : lookup.candidates) {
+        if (candidate.loosePath.isEmpty()) {
+            appendArchiveLocations(locations, candidate);
+        } else if (DirectorySnapshots::instance().isFile(candidate.loosePath)) {
+            locations.append({.loosePath = candidate.loosePath, .archiveRead = std::nullopt});
+            if (candidate.endsLookup) {
+                return locations;
+            }
+        }
+    }
+
+    if (locations.isEmpty() && !lookup.texturePath.isEmpty()) {
+        MissingDataFiles::instance().insert(lookup.sourceKey, lookup.texturePath);
+    }
+    return locations;
+}
+
+TextureLoader::Location TextureLoader::locateDataFile(const QString& dataPath) const {
+    if (dataPath.isEmpty() || !m_MOInfo) {
+        return {};
+    }
+
+    auto& missingFiles = MissingDataFiles::instance();
+    const auto sourceKey = textureProviderKey(m_TextureSource);
+    if (missingFiles.contains(sourceKey, dataPath)) {
+        return {};
+    }
+
+    if (m_TextureSource.kind != TextureSourceProviderKind::Auto) {
+        if (!m_TextureSource.sourcePath.isEmpty()) {
+            const auto realPath = QDir(m_TextureSource.sourcePath).absoluteFilePath(QDir::cleanPath(dataPath));
+            if (DirectorySnapshots::instance().isFile(realPath)) {
+                return {.loosePath = realPath, .archiveRead = std::nullopt};
+            }
+        }
+
+        if (auto read = locateInArchives(sourceArchiveOwner(), m_TextureSource.archivePaths, dataPath)) {
+            return {.loosePath = {}, .archiveRead = std::move(read)};
+        }
+    }
+
+    const auto realPath = MoDataPaths::resolveDataPath(m_MOInfo, dataPath);
+    if (!realPath.isEmpty() && DirectorySnapshots::instance().isFile(realPath)) {
+        return {.loosePath = realPath, .archiveRead = std::nullopt};
+    }
+
+    if (auto read = locateInMods(dataPath)) {
+        return {.loosePath = {}, .archiveRead = std::move(read)};
+    }
+
+    const auto gameArchives = MoDataPaths::archivePathsFromGame(m_MOInfo);
+    auto read = locateInArchives(ArchiveIndex::GameOwner, gameArchives, dataPath);
+    if (!read) {
+        missingFiles.insert(sourceKey, dataPath);
+    }
+    return {.loosePath = {}, .archiveRead = std::move(read)};
+}
+
+std::optional<ArchiveAccess::BatchRead> TextureLoader::locateInMods(const QString& dataPath) const {
+    const auto fileOrigins = m_MOInfo->getFileOrigins(dataPath);
+    if (fileOrigins.empty()) {
+        return std::nullopt;
+    }
+
+    const auto& modName = fileOrigins.constFirst();
+    if (auto* const mod = m_MOInfo->modList()->getMod(modName)) {
+        return locateInArchives(modName, MoDataPaths::archivePathsFromMod(mod), dataPath);
+    }
+    return std::nullopt;
+}
+
+std::optional<ArchiveAccess::BatchRead> TextureLoader::locateInArchives(
+    const QString& owner,
+    const QStringList& archivePaths,
+    const QString& dataPath
+) {
+    if (ArchiveIndexer::ensureIndexed(owner, archivePaths)) {
+        const auto locations = ArchiveIndex::instance().locate(owner, dataPath);
+        if (locations.isEmpty()) {
+            return std::nullopt;
+        }
+        return ArchiveAccess::BatchRead {
+            .archivePath = locations.constFirst().archivePath,
+            .dataPath = locations.constFirst().recordPath,
+        };
+    }
+
+    for (const auto& archivePath : archivePaths) {
+        if (ArchiveAccess::containsDataPath(archivePath, dataPath)) {
+            return ArchiveAccess::BatchRead {.archivePath = archivePath, .dataPath = dataPath};
+        }
+    }
+    return std::nullopt;
+}
+
+void TextureLoader::appendArchiveLocations(QVector<Location>& locations, const Candidate& candidate) {
+    if (ArchiveIndexer::ensureIndexed(candidate.owner, candidate.archivePaths)) {
+        for (const auto& location : ArchiveIndex::instance().locate(candidate.owner, candidate.dataPath)) {
+            const ArchiveAccess::BatchRead read {.archivePath = location.archivePath, .dataPath = location.recordPath};
+            locations.append({.loosePath = {}, .archiveRead = read});
+        }
+        return;
+    }
+
+    for (const auto& archivePath : candidate.archivePaths) {
+        if (ArchiveAccess::containsDataPath(archivePath, candidate.dataPath)) {
+            const ArchiveAccess::BatchRead read {.archivePath = archivePath, .dataPath = candidate.dataPath};
+            locations.append({.loosePath = {}, .archiveRead = read});
+        }
+    }
 }
 
 std::unique_ptr<PreviewTexture> TextureLoader::loadAuto(const QString& texturePath) const {
@@ -56,7 +268,7 @@ std::unique_ptr<PreviewTexture> TextureLoader::loadAuto(const QString& texturePa
 
     for (const auto& path : textureDataPathVariants(texturePath)) {
         const auto realPath = MoDataPaths::resolveDataPath(m_MOInfo, path);
-        const bool fileExists = !realPath.isEmpty() && QFileInfo::exists(realPath) && QFileInfo(realPath).isFile();
+        const bool fileExists = !realPath.isEmpty() && DirectorySnapshots::instance().isFile(realPath);
 
         if (fileExists) {
             return loadLooseTexture(realPath);
@@ -87,7 +299,7 @@ std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromSource(const QString&
             if (!m_TextureSource.sourcePath.isEmpty()) {
                 for (const auto& path : textureDataPathVariants(texturePath)) {
                     const auto realPath = QDir(m_TextureSource.sourcePath).absoluteFilePath(QDir::cleanPath(path));
-                    if (QFileInfo::exists(realPath) && QFileInfo(realPath).isFile()) {
+                    if (DirectorySnapshots::instance().isFile(realPath)) {
                         if (auto texture = loadLooseTexture(realPath)) {
                             return texture;
                         }
@@ -95,7 +307,7 @@ std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromSource(const QString&
                 }
             }
 
-            return tryLoadFromArchives(m_TextureSource.archivePaths, texturePath);
+            return tryLoadFromArchives(sourceArchiveOwner(), m_TextureSource.archivePaths, texturePath);
         }
         case TextureSourceProviderKind::Auto: return nullptr;
     }
@@ -103,26 +315,53 @@ std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromSource(const QString&
     return nullptr;
 }
 
-std::unique_ptr<PreviewTexture> TextureLoader::loadLooseTexture(const QString& path) {
+DecodedTexture TextureLoader::decode(
+    ArchiveAccess::ExtractedBytes bytes,
+    const QString& texturePath,
+    const QString& archivePath
+) {
+    const auto source = archivePath.isEmpty()
+                            ? QStringLiteral("loose DDS '%1'").arg(texturePath)
+                            : QStringLiteral("BSA DDS '%1' from '%2'").arg(texturePath, archivePath);
     try {
-        auto texture = DdsTextures::loadFileIfValid(path);
-        if (texture.empty()) {
-            qWarning("Failed to decode loose DDS '%s': invalid or unsupported DDS", qUtf8Printable(path));
-            return nullptr;
+        auto image = DdsTextures::viewIfValid(bytes.data(), bytes.size());
+        if (image.empty()) {
+            qWarning("Failed to decode %s: invalid or unsupported DDS", qUtf8Printable(source));
+            return {};
         }
-        return TextureUpload::upload(texture);
+        return {.bytes = std::move(bytes), .image = image};
     } catch (const std::exception& e) {
-        qWarning("Failed to decode loose DDS '%s': %s", qUtf8Printable(path), e.what());
+        qWarning("Failed to decode %s: %s", qUtf8Printable(source), e.what());
+        return {};
+    }
+}
+
+std::unique_ptr<PreviewTexture> TextureLoader::loadLooseTexture(const QString& path) {
+    auto bytes = MappedFile::read(path);
+    if (bytes.isEmpty()) {
         return nullptr;
     }
+
+    const auto decoded = decode(std::move(bytes), path);
+    return decoded.image.empty() ? nullptr : TextureUpload::upload(decoded.image);
 }
 
 std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromArchives(
+    const QString& owner,
     const QStringList& archivePaths,
     const QString& texturePath
 ) {
-    for (const auto& archivePath : archivePaths) {
-        if (auto texture = loadFromArchive(archivePath, texturePath)) {
+    if (!ArchiveIndexer::ensureIndexed(owner, archivePaths)) {
+        for (const auto& archivePath : archivePaths) {
+            if (auto texture = loadFromArchive(archivePath, texturePath)) {
+                return texture;
+            }
+        }
+        return nullptr;
+    }
+
+    for (const auto& location : ArchiveIndex::instance().locate(owner, texturePath)) {
+        if (auto texture = loadFromArchive(location.archivePath, location.recordPath)) {
             return texture;
         }
     }
@@ -143,7 +382,7 @@ std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromMods(const QString& te
 
         const auto& modName = fileOrigins.constFirst();
         if (auto* const mod = m_MOInfo->modList()->getMod(modName)) {
-            if (auto texture = tryLoadFromArchives(MoDataPaths::archivePathsFromMod(mod), path)) {
+            if (auto texture = tryLoadFromArchives(modName, MoDataPaths::archivePathsFromMod(mod), path)) {
                 return texture;
             }
         }
@@ -157,43 +396,29 @@ std::unique_ptr<PreviewTexture> TextureLoader::tryLoadFromGame(const QString& te
         return nullptr;
     }
 
-    return tryLoadFromArchives(MoDataPaths::archivePathsFromGame(m_MOInfo), texturePath);
+    return tryLoadFromArchives(
+        ArchiveIndex::GameOwner,
+        MoDataPaths::archivePathsFromGame(m_MOInfo),
+        texturePath
+    );
 }
 
 std::unique_ptr<PreviewTexture> TextureLoader::loadFromArchive(const QString& archivePath, const QString& texturePath) {
-    libbsarch::bs_archive archive;
-    if (!ArchiveAccess::loadArchive(archive, archivePath)) {
-        return nullptr;
-    }
-
-    const auto buffer = ArchiveAccess::extractBytes(archive, texturePath);
+    auto buffer = ArchiveAccess::extractView(archivePath, texturePath);
     if (buffer.isEmpty()) {
         return nullptr;
     }
 
-    try {
-        auto texture = DdsTextures::loadIfValid(buffer.constData(), static_cast<std::size_t>(buffer.size()));
-        if (texture.empty()) {
-            qWarning(
-                "Failed to decode BSA DDS '%s' from '%s': invalid or unsupported DDS",
-                qUtf8Printable(texturePath),
-                qUtf8Printable(archivePath)
-            );
-            return nullptr;
-        }
-        return TextureUpload::upload(texture);
-    } catch (const std::exception& e) {
-        qWarning(
-            "Failed to decode BSA DDS '%s' from '%s': %s",
-            qUtf8Printable(texturePath),
-            qUtf8Printable(archivePath),
-            e.what()
-        );
-        return nullptr;
-    }
+    const auto decoded = decode(std::move(buffer), texturePath, archivePath);
+    return decoded.image.empty() ? nullptr : TextureUpload::upload(decoded.image);
+}
+
+QString TextureLoader::sourceArchiveOwner() const {
+    return m_TextureSource.kind == TextureSourceProviderKind::Mod ? m_TextureSource.sourceName
+                                                                  : QString(ArchiveIndex::GameOwner);
 }
 
-QByteArray TextureLoader::loadDataFileAuto(const QString& dataPath) const {
+ArchiveAccess::ExtractedBytes TextureLoader::loadDataFileAuto(const QString& dataPath) const {
     if (dataPath.isEmpty()) {
         return {};
     }
@@ -204,10 +429,10 @@ QByteArray TextureLoader::loadDataFileAuto(const QString& dataPath) const {
     }
 
     const auto realPath = MoDataPaths::resolveDataPath(m_MOInfo, dataPath);
-    const bool fileExists = !realPath.isEmpty() && QFileInfo::exists(realPath) && QFileInfo(realPath).isFile();
+    const bool fileExists = !realPath.isEmpty() && DirectorySnapshots::instance().isFile(realPath);
 
     if (fileExists) {
-        return loadLooseDataFile(realPath);
+        return MappedFile::read(realPath);
     }
 
     if (auto data = tryLoadDataFileFromMods(dataPath); !data.isEmpty()) {
@@ -217,7 +442,7 @@ QByteArray TextureLoader::loadDataFileAuto(const QString& dataPath) const {
     return tryLoadDataFileFromGame(dataPath);
 }
 
-QByteArray TextureLoader::tryLoadDataFileFromSource(const QString& dataPath) const {
+ArchiveAccess::ExtractedBytes TextureLoader::tryLoadDataFileFromSource(const QString& dataPath) const {
     if (m_TextureSource.kind == TextureSourceProviderKind::Auto) {
         return {};
     }
@@ -227,14 +452,14 @@ QByteArray TextureLoader::tryLoadDataFileFromSource(const QString& dataPath) con
         case TextureSourceProviderKind::GameData: {
             if (!m_TextureSource.sourcePath.isEmpty()) {
                 const auto realPath = QDir(m_TextureSource.sourcePath).absoluteFilePath(QDir::cleanPath(dataPath));
-                if (QFileInfo::exists(realPath) && QFileInfo(realPath).isFile()) {
-                    if (auto data = loadLooseDataFile(realPath); !data.isEmpty()) {
+                if (DirectorySnapshots::instance().isFile(realPath)) {
+                    if (auto data = MappedFile::read(realPath); !data.isEmpty()) {
                         return data;
                     }
                 }
             }
 
-            return tryLoadDataFileFromArchives(m_TextureSource.archivePaths, dataPath);
+            return tryLoadDataFileFromArchives(sourceArchiveOwner(), m_TextureSource.archivePaths, dataPath);
         }
         case TextureSourceProviderKind::Auto: return {};
     }
@@ -242,9 +467,22 @@ QByteArray TextureLoader::tryLoadDataFileFromSource(const QString& dataPath) con
     return {};
 }
 
-QByteArray TextureLoader::tryLoadDataFileFromArchives(const QStringList& archivePaths, const QString& dataPath) {
-    for (const auto& archivePath : archivePaths) {
-        if (auto data = loadDataFileFromArchive(archivePath, dataPath); !data.isEmpty()) {
+ArchiveAccess::ExtractedBytes TextureLoader::tryLoadDataFileFromArchives(
+    const QString& owner,
+    const QStringList& archivePaths,
+    const QString& dataPath
+) {
+    if (!ArchiveIndexer::ensureIndexed(owner, archivePaths)) {
+        for (const auto& archivePath : archivePaths) {
+            if (auto data = ArchiveAccess::extractView(archivePath, dataPath); !data.isEmpty()) {
+                return data;
+            }
+        }
+        return {};
+    }
+
+    for (const auto& location : ArchiveIndex::instance().locate(owner, dataPath)) {
+        if (auto data = ArchiveAccess::extractView(location.archivePath, location.recordPath); !data.isEmpty()) {
             return data;
         }
     }
@@ -252,7 +490,7 @@ QByteArray TextureLoader::tryLoadDataFileFromArchives(const QStringList& archive
     return {};
 }
 
-QByteArray TextureLoader::tryLoadDataFileFromMods(const QString& dataPath) const {
+ArchiveAccess::ExtractedBytes TextureLoader::tryLoadDataFileFromMods(const QString& dataPath) const {
     if (!m_MOInfo) {
         return {};
     }
@@ -264,34 +502,19 @@ QByteArray TextureLoader::tryLoadDataFileFromMods(const QString& dataPath) const
 
     const auto& modName = fileOrigins.constFirst();
     if (auto* const mod = m_MOInfo->modList()->getMod(modName)) {
-        return tryLoadDataFileFromArchives(MoDataPaths::archivePathsFromMod(mod), dataPath);
+        return tryLoadDataFileFromArchives(modName, MoDataPaths::archivePathsFromMod(mod), dataPath);
     }
     return {};
 }
 
-QByteArray TextureLoader::tryLoadDataFileFromGame(const QString& dataPath) const {
+ArchiveAccess::ExtractedBytes TextureLoader::tryLoadDataFileFromGame(const QString& dataPath) const {
     if (!m_MOInfo) {
         return {};
     }
 
-    return tryLoadDataFileFromArchives(MoDataPaths::archivePathsFromGame(m_MOInfo), dataPath);
-}
-
-QByteArray TextureLoader::loadLooseDataFile(const QString& path) {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning("Failed to read loose data file '%s'", qUtf8Printable(path));
-        return {};
-    }
-
-    return file.readAll();
-}
-
-QByteArray TextureLoader::loadDataFileFromArchive(const QString& archivePath, const QString& dataPath) {
-    libbsarch::bs_archive archive;
-    if (!ArchiveAccess::loadArchive(archive, archivePath)) {
-        return {};
-    }
-
-    return ArchiveAccess::extractBytes(archive, dataPath);
+    return tryLoadDataFileFromArchives(
+        ArchiveIndex::GameOwner,
+        MoDataPaths::archivePathsFromGame(m_MOInfo),
+        dataPath
+    );
 }
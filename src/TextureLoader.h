@@ -1,12 +1,15 @@
 #pragma once
 
+#include "ArchiveAccess.h"
+#include "DdsTextures.h"
 #include "TextureSource.h"
 
-#include <QByteArray>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 #include <memory>
+#include <optional>
 
 class PreviewTexture;
 
@@ -14,18 +17,71 @@ namespace MOBase {
 class IOrganizer;
 }
 
+// A validated DDS whose image points into bytes; produced off the GL thread.
+struct DecodedTexture {
+    ArchiveAccess::ExtractedBytes bytes;
+    DdsImageView image;
+};
+
 class TextureLoader {
 public:
     explicit TextureLoader(MOBase::IOrganizer* organizer, TextureSourceProvider textureSource = {});
 
     [[nodiscard]] std::unique_ptr<PreviewTexture> load(const QString& texturePath) const;
-    [[nodiscard]] QByteArray loadDataFile(const QString& dataPath) const;
+    [[nodiscard]] ArchiveAccess::ExtractedBytes loadDataFile(const QString& dataPath) const;
+
+    // Resolve every path first, then read all archive records through one ArchiveAccess batch.
+    // Results follow the input order; failed batch reads fall back to loadDataFile().
+    [[nodiscard]] QVector<ArchiveAccess::ExtractedBytes> loadDataFiles(const QStringList& dataPaths) const;
+
+    struct Location {
+        QString loosePath;
+        std::optional<ArchiveAccess::BatchRead> archiveRead;
+    };
+
+    // A loose file to check or an owner's archives to search for dataPath.
+    struct Candidate {
+        QString loosePath;
+        // Like loadAuto(), an existing loose file ends the lookup.
+        bool endsLookup = false;
+        QString owner;
+        QStringList archivePaths;
+        QString dataPath;
+    };
+
+    // The MO2 side of a texture lookup: every place load() would try, in the same order.
+    struct Lookup {
+        QString sourceKey;
+        QString texturePath;
+        QVector<Candidate> candidates;
+    };
+
+    // Uses MO2 and must run on the GUI thread; touches no archive. No candidates means the
+    // texture is missing.
+    [[nodiscard]] Lookup lookupTexture(const QString& texturePath) const;
+    // Checks loose files and searches archives on any thread; returns every readable location
+    // in lookup order, or none after recording the texture as missing.
+    [[nodiscard]] static QVector<Location> resolveLookup(const Lookup& lookup);
+    [[nodiscard]] static DecodedTexture decode(
+        ArchiveAccess::ExtractedBytes bytes,
+        const QString& texturePath,
+        const QString& archivePath = {}
+    );
 
 private:
+    [[nodiscard]] Location locateDataFile(const QString& dataPath) const;
+    [[nodiscard]] std::optional<ArchiveAccess::BatchRead> locateInMods(const QString& dataPath) const;
+    [[nodiscard]] static std::optional<ArchiveAccess::BatchRead> locateInArchives(
+        const QString& owner,
+        const QStringList& archivePaths,
+        const QString& dataPath
+    );
+    static void appendArchiveLocations(QVector<Location>& locations, const Candidate& candidate);
     [[nodiscard]] std::unique_ptr<PreviewTexture> loadAuto(const QString& texturePath) const;
     [[nodiscard]] std::unique_ptr<PreviewTexture> tryLoadFromSource(const QString& texturePath) const;
     [[nodiscard]] static std::unique_ptr<PreviewTexture> loadLooseTexture(const QString& path);
     [[nodiscard]] static std::unique_ptr<PreviewTexture> tryLoadFromArchives(
+        const QString& owner,
         const QStringList& archivePaths,
         const QString& texturePath
     );
@@ -35,16 +91,16 @@ private:
         const QString& archivePath,
         const QString& texturePath
     );
-    [[nodiscard]] QByteArray loadDataFileAuto(const QString& dataPath) const;
-    [[nodiscard]] QByteArray tryLoadDataFileFromSource(const QString& dataPath) const;
-    [[nodiscard]] static QByteArray tryLoadDataFileFromArchives(
+    [[nodiscard]] QString sourceArchiveOwner() const;
+    [[nodiscard]] ArchiveAccess::ExtractedBytes loadDataFileAuto(const QString& dataPath) const;
+    [[nodiscard]] ArchiveAccess::ExtractedBytes tryLoadDataFileFromSource(const QString& dataPath) const;
+    [[nodiscard]] static ArchiveAccess::ExtractedBytes tryLoadDataFileFromArchives(
+        const QString& owner,
         const QStringList& archivePaths,
         const QString& dataPath
     );
-    [[nodiscard]] QByteArray tryLoadDataFileFromMods(const QString& dataPath) const;
-    [[nodiscard]] QByteArray tryLoadDataFileFromGame(const QString& dataPath) const;
-    [[nodiscard]] static QByteArray loadLooseDataFile(const QString& path);
-    [[nodiscard]] static QByteArray loadDataFileFromArchive(const QString& archivePath, const QString& dataPath);
+    [[nodiscard]] ArchiveAccess::ExtractedBytes tryLoadDataFileFromMods(const QString& dataPath) const;
+    [[nodiscard]] ArchiveAccess::ExtractedBytes tryLoadDataFileFromGame(const QString& dataPath) const;
 
     MOBase::IOrganizer* m_MOInfo = nullptr;
     TextureSourceProvider m_TextureSource;
@@ -1,24 +1,321 @@
 #include "TextureManager.h"
+#include "ArchiveAccess.h"
+#include "DdsTextures.h"
+#include "DecodedTextureCache.h"
 #include "Fo4Material.h"
+#include "Fo4MaterialCache.h"
+#include "MappedFile.h"
+#include "PreviewTexture.h"
 #include "TextureCache.h"
 #include "TextureLoader.h"
+#include "TextureUpload.h"
 
+#include <QByteArray>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
 #include <QString>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
-TextureManager::TextureManager(MOBase::IOrganizer* organizer, TextureSourceProvider textureSource)
-    : m_Loader {std::make_unique<TextureLoader>(organizer, std::move(textureSource))}
-    , m_Cache {std::make_unique<TextureCache>()} {}
+namespace {
+// Textures no widget uses any more stay uploaded until they exceed this much video memory.
+constexpr std::size_t UnusedTextureBudget = std::size_t {512} * 1024 * 1024;
 
-TextureManager::~TextureManager() = default;
+struct TextureRequest {
+    QString texturePath;
+    DataPathKey cacheKey;
+    // Resolved on the worker, so archive directories are never read on the GUI thread.
+    TextureLoader::Lookup lookup;
+};
+
+struct DecodedResult {
+    QString texturePath;
+    DataPathKey cacheKey;
+    DecodedTexture texture;
+};
+
+QThreadPool& textureThreadPool() {
+    static QThreadPool pool;
+    return pool;
+}
+
+// Cached textures keep a copy of only the levels that pass max_texture_size, so the entry
+// neither charges for levels that are never uploaded nor keeps the mod's file or the whole
+// archive mapped and locked. The upload uses the same copy.
+DecodedTexture decodeAndCache(
+    ArchiveAccess::ExtractedBytes bytes,
+    const QString& sourceKey,
+    const QString& texturePath,
+    const QString& archivePath = {}
+) {
+    auto texture = TextureLoader::decode(std::move(bytes), texturePath, archivePath);
+    auto& decodedCache = DecodedTextureCache::instance();
+    const auto viewedBytes = DdsTextures::viewedBytes(texture.image);
+    if (sourceKey.isEmpty() || viewedBytes == 0 || !decodedCache.fitsBudget(viewedBytes)) {
+        return texture;
+    }
+
+    QByteArray levels(static_cast<qsizetype>(viewedBytes), Qt::Uninitialized);
+    const auto image = DdsTextures::copyViewed(texture.image, levels.data());
+    DecodedTexture cached {.bytes = ArchiveAccess::ExtractedBytes(std::move(levels)), .image = image};
+    decodedCache.insert(sourceKey, cached);
+    return cached;
+}
+
+QVector<TextureLoader::Location> resolveRequest(const TextureRequest& request) {
+    try {
+        return TextureLoader::resolveLookup(request.lookup);
+    } catch (const std::exception& e) {
+        qWarning("Failed to locate NIF texture '%s': %s", qUtf8Printable(request.texturePath), e.what());
+    } catch (...) {
+        qWarning("Failed to locate NIF texture '%s': unknown exception", qUtf8Printable(request.texturePath));
+    }
+    return {};
+}
+
+// Tries the locations after the first, in lookup order, when the first one did not decode.
+DecodedTexture decodeFallbacks(const QVector<TextureLoader::Location>& locations) {
+    for (qsizetype i = 1; i < locations.size(); ++i) {
+        const auto& location = locations[i];
+        const auto& read = location.archiveRead;
+        auto bytes = read ? ArchiveAccess::extractView(read->archivePath, read->dataPath)
+                          : MappedFile::read(location.loosePath);
+        if (bytes.isEmpty()) {
+            continue;
+        }
+
+        auto texture = read ? TextureLoader::decode(std::move(bytes), read->dataPath, read->archivePath)
+                            : TextureLoader::decode(std::move(bytes), location.loosePath);
+        if (!texture.image.empty()) {
+            return texture;
+        }
+    }
+    return {};
+}
+} // namespace
+
+// Textures, decoded results and progressive uploads shared by every TextureManager whose
+// widget context belongs to one OpenGL share group, so split panes and recreated widgets
+// reuse uploaded textures. Lives until the last context of the group is destroyed.
+struct TextureShareGroup {
+    // Shared with worker tasks so they can outlive the group; results pushed after close() are dropped.
+    struct Pipeline {
+        std::mutex mutex;
+        std::vector<QObject*> updateTargets;
+        std::uint64_t generation = 0;
+        std::deque<DecodedResult> decoded;
+
+        void push(const std::uint64_t taskGeneration, DecodedResult result) {
+            const std::scoped_lock lock(mutex);
+            if (taskGeneration != generation) {
+                return;
+            }
+
+            decoded.push_back(std::move(result));
+            if (decoded.size() == 1) {
+                for (auto* const updateTarget : updateTargets) {
+                    QMetaObject::invokeMethod(updateTarget, "update", Qt::QueuedConnection);
+                }
+            }
+        }
+
+        void close() {
+            const std::scoped_lock lock(mutex);
+            updateTargets.clear();
+            ++generation;
+            decoded.clear();
+        }
+    };
+
+    // A texture that samples only its mip tail; the larger levels are uploaded one per step.
+    struct ProgressiveUpload {
+        DataPathKey cacheKey;
+        DecodedTexture texture;
+        std::size_t nextLevel = 0;
+    };
+
+    [[nodiscard]] static std::shared_ptr<TextureShareGroup> forContext(QOpenGLContext* context);
+
+    QOpenGLContextGroup* group = nullptr;
+    QVector<QOpenGLContext*> contexts;
+    TextureCache cache;
+    std::shared_ptr<Pipeline> pipeline = std::make_shared<Pipeline>();
+    std::vector<ProgressiveUpload> progressiveUploads;
+
+    static void detachContext(QOpenGLContextGroup* group, QOpenGLContext* context);
+};
+
+namespace {
+std::map<QOpenGLContextGroup*, std::shared_ptr<TextureShareGroup>>& shareGroups() {
+    static std::map<QOpenGLContextGroup*, std::shared_ptr<TextureShareGroup>> groups;
+    return groups;
+}
+} // namespace
+
+std::shared_ptr<TextureShareGroup> TextureShareGroup::forContext(QOpenGLContext* context) {
+    if (!context) {
+        return std::make_shared<TextureShareGroup>();
+    }
+
+    auto& shareGroup = shareGroups()[context->shareGroup()];
+    if (!shareGroup) {
+        shareGroup = std::make_shared<TextureShareGroup>();
+        shareGroup->group = context->shareGroup();
+    }
+    if (!shareGroup->contexts.contains(context)) {
+        shareGroup->contexts.append(context);
+        QObject::connect(context, &QOpenGLContext::aboutToBeDestroyed, context, [group = shareGroup->group, context] {
+            detachContext(group, context);
+        });
+    }
+    return shareGroup;
+}
+
+void TextureShareGroup::detachContext(QOpenGLContextGroup* group, QOpenGLContext* context) {
+    auto& groups = shareGroups();
+    const auto it = groups.find(group);
+    if (it == groups.end()) {
+        return;
+    }
+
+    auto& shareGroup = *it->second;
+    shareGroup.contexts.removeAll(context);
+    if (!shareGroup.contexts.isEmpty()) {
+        return;
+    }
+
+    // The textures go away with the group, so delete them while its last context still works.
+    shareGroup.pipeline->close();
+    shareGroup.progressiveUploads.clear();
+
+    auto* const previousContext = QOpenGLContext::currentContext();
+    auto* const previousSurface = previousContext ? previousContext->surface() : nullptr;
+    QOffscreenSurface surface;
+    surface.setFormat(context->format());
+    surface.create();
+    if (context->makeCurrent(&surface)) {
+        shareGroup.cache.cleanup();
+        context->doneCurrent();
+    } else {
+        qWarning("Failed to make the last OpenGL context of a texture share group current for cleanup");
+    }
+    if (previousContext && previousContext != context) {
+        previousContext->makeCurrent(previousSurface);
+    }
+
+    groups.erase(it);
+}
+
+TextureManager::TextureManager(
+    MOBase::IOrganizer* organizer,
+    TextureSourceProvider textureSource,
+    QObject* updateTarget
+)
+    : m_SourceKey {textureProviderKey(textureSource)}
+    , m_Loader {std::make_unique<const TextureLoader>(organizer, std::move(textureSource))}
+    , m_UpdateTarget {updateTarget} {}
+
+TextureManager::~TextureManager() {
+    detachShareGroup();
+}
 
 void TextureManager::cleanup() {
-    m_Cache->cleanup();
+    if (!m_ShareGroup) {
+        return;
+    }
+
+    for (const auto& key : m_UsedKeys) {
+        m_ShareGroup->cache.release(key);
+    }
+    m_UsedKeys.clear();
+    m_ShareGroup->cache.trim(UnusedTextureBudget);
+}
+
+TextureShareGroup& TextureManager::shareGroup() {
+    auto* const context = QOpenGLContext::currentContext();
+    if (m_ShareGroup && (!context || m_ShareGroup->group == context->shareGroup())) {
+        return *m_ShareGroup;
+    }
+
+    detachShareGroup();
+    m_ShareGroup = TextureShareGroup::forContext(context);
+    if (m_UpdateTarget) {
+        const std::scoped_lock lock(m_ShareGroup->pipeline->mutex);
+        m_ShareGroup->pipeline->updateTargets.push_back(m_UpdateTarget);
+    }
+    return *m_ShareGroup;
+}
+
+void TextureManager::detachShareGroup() {
+    if (!m_ShareGroup) {
+        return;
+    }
+
+    for (const auto& key : m_UsedKeys) {
+        m_ShareGroup->cache.release(key);
+    }
+    m_UsedKeys.clear();
+    {
+        auto& pipeline = *m_ShareGroup->pipeline;
+        const std::scoped_lock lock(pipeline.mutex);
+        std::erase(pipeline.updateTargets, m_UpdateTarget);
+    }
+    m_ShareGroup.reset();
+}
+
+// Qualified by the texture source, since providers resolve the same path to different files.
+DataPathKey TextureManager::cacheKey(const QString& normalizedPath) const {
+    return DataPathKey(m_SourceKey + normalizedPath);
+}
+
+void TextureManager::useTexture(const DataPathKey& key) {
+    if (!m_UsedKeys.contains(key)) {
+        m_UsedKeys.insert(key);
+        m_ShareGroup->cache.acquire(key);
+    }
+}
+
+void TextureManager::prefetchTextures(const QStringList& texturePaths) {
+    auto& shareGroup = this->shareGroup();
+    QStringList pendingPaths;
+    QVector<DataPathKey> keys;
+    for (const auto& texturePath : texturePaths) {
+        const auto normalizedPath = normalizeTextureDataPath(texturePath);
+        if (normalizedPath.isEmpty()) {
+            continue;
+        }
+
+        const auto key = cacheKey(normalizedPath);
+        if (!shareGroup.cache.containsTexture(key) && !pendingPaths.contains(normalizedPath, Qt::CaseInsensitive)) {
+            pendingPaths.append(normalizedPath);
+        }
+        keys.append(key);
+    }
+
+    if (!pendingPaths.isEmpty()) {
+        requestTextures(pendingPaths);
+    }
+    for (const auto& key : keys) {
+        useTexture(key);
+    }
 }
 
 PreviewTexture* TextureManager::getTexture(const std::string& texturePath) {
@@ -31,44 +328,214 @@ PreviewTexture* TextureManager::getTexture(const QString& texturePath) {
         return nullptr;
     }
 
-    if (m_Cache->containsTexture(normalizedPath)) {
-        return m_Cache->texture(normalizedPath);
+    auto& shareGroup = this->shareGroup();
+    const auto key = cacheKey(normalizedPath);
+    if (!shareGroup.cache.containsTexture(key)) {
+        requestTextures({normalizedPath});
     }
+    useTexture(key);
+    return shareGroup.cache.texture(key);
+}
 
-    std::unique_ptr<PreviewTexture> texture;
-    try {
-        texture = m_Loader->load(normalizedPath);
-    } catch (const std::exception& e) {
-        qWarning("Failed to load NIF texture '%s': %s", qUtf8Printable(normalizedPath), e.what());
-    } catch (...) {
-        qWarning("Failed to load NIF texture '%s': unknown exception", qUtf8Printable(normalizedPath));
+void TextureManager::requestTextures(const QStringList& texturePaths) {
+    auto& shareGroup = this->shareGroup();
+    QVector<TextureRequest> requests;
+    for (const auto& texturePath : texturePaths) {
+        const auto key = cacheKey(texturePath);
+        TextureLoader::Lookup lookup;
+        try {
+            lookup = m_Loader->lookupTexture(texturePath);
+        } catch (const std::exception& e) {
+            qWarning("Failed to locate NIF texture '%s': %s", qUtf8Printable(texturePath), e.what());
+        } catch (...) {
+            qWarning("Failed to locate NIF texture '%s': unknown exception", qUtf8Printable(texturePath));
+        }
+
+        // Textures known to be missing are cached as null right away so shapes pick their
+        // fallbacks; ones the worker finds missing fail their pending texture instead.
+        if (lookup.candidates.isEmpty()) {
+            shareGroup.cache.storeTexture(key, nullptr);
+            continue;
+        }
+
+        shareGroup.cache.storeTexture(key, std::make_unique<PreviewTexture>());
+        requests.append({.texturePath = texturePath, .cacheKey = key, .lookup = std::move(lookup)});
     }
 
-    return m_Cache->storeTexture(normalizedPath, std::move(texture));
+    if (requests.isEmpty()) {
+        return;
+    }
+
+    std::uint64_t generation = 0;
+    {
+        const std::scoped_lock lock(shareGroup.pipeline->mutex);
+        generation = shareGroup.pipeline->generation;
+    }
+
+    // Leave half of the cores to MO2 and the GUI thread.
+    textureThreadPool().setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+    textureThreadPool().start([pipeline = shareGroup.pipeline, generation, requests = std::move(requests)] {
+        auto& decodedCache = DecodedTextureCache::instance();
+        QVector<ArchiveAccess::BatchRead> reads;
+        QVector<qsizetype> readRequests;
+        QStringList readKeys;
+        QVector<QVector<TextureLoader::Location>> locations(requests.size());
+        for (qsizetype i = 0; i < requests.size(); ++i) {
+            const auto& request = requests[i];
+            locations[i] = resolveRequest(request);
+            if (locations[i].isEmpty()) {
+                pipeline->push(
+                    generation,
+                    {.texturePath = request.texturePath, .cacheKey = request.cacheKey, .texture = {}}
+                );
+                continue;
+            }
+
+            const auto& location = locations[i].constFirst();
+            const auto sourceKey = DecodedTextureCache::sourceKey(location);
+            if (auto texture = decodedCache.find(sourceKey)) {
+                pipeline->push(
+                    generation,
+                    {.texturePath = request.texturePath, .cacheKey = request.cacheKey, .texture = std::move(*texture)}
+                );
+                continue;
+            }
+
+            if (location.archiveRead) {
+                reads.append(*location.archiveRead);
+                readRequests.append(i);
+                readKeys.append(sourceKey);
+                continue;
+            }
+
+            auto texture = decodeAndCache(MappedFile::read(location.loosePath), sourceKey, location.loosePath);
+            if (texture.image.empty()) {
+                texture = decodeFallbacks(locations[i]);
+            }
+            pipeline->push(
+                generation,
+                {.texturePath = request.texturePath, .cacheKey = request.cacheKey, .texture = std::move(texture)}
+            );
+        }
+
+        auto buffers = ArchiveAccess::extractBatch(reads);
+        for (qsizetype i = 0; i < reads.size(); ++i) {
+            const auto& request = requests[readRequests[i]];
+            DecodedTexture texture;
+            if (!buffers[i].isEmpty()) {
+                texture = decodeAndCache(std::move(buffers[i]), readKeys[i], reads[i].dataPath, reads[i].archivePath);
+            }
+            if (texture.image.empty()) {
+                texture = decodeFallbacks(locations[readRequests[i]]);
+            }
+            pipeline->push(
+                generation,
+                {.texturePath = request.texturePath, .cacheKey = request.cacheKey, .texture = std::move(texture)}
+            );
+        }
+    });
 }
 
-QStringList TextureManager::getFo4MaterialTextures(const QString& materialPath) const {
+bool TextureManager::processUploads(const std::chrono::milliseconds budget) {
+    auto& shareGroup = this->shareGroup();
+    auto& pipeline = *shareGroup.pipeline;
+    auto& progressiveUploads = shareGroup.progressiveUploads;
+    QElapsedTimer timer;
+    timer.start();
+    bool decodedWaiting = true;
+    while (timer.elapsed() < budget.count()) {
+        DecodedResult result;
+        {
+            const std::scoped_lock lock(pipeline.mutex);
+            if (pipeline.decoded.empty()) {
+                decodedWaiting = false;
+                break;
+            }
+            result = std::move(pipeline.decoded.front());
+            pipeline.decoded.pop_front();
+        }
+
+        auto* const texture = shareGroup.cache.texture(result.cacheKey);
+        if (!texture || texture->state() != PreviewTexture::State::Pending) {
+            continue;
+        }
+
+        std::unique_ptr<PreviewTexture> uploaded;
+        try {
+            if (!result.texture.image.empty()) {
+                std::size_t firstLevel = 0;
+                uploaded = TextureUpload::beginProgressive(result.texture.image, firstLevel);
+                if (!uploaded) {
+                    uploaded = TextureUpload::upload(result.texture.image);
+                } else if (firstLevel > 0) {
+                    progressiveUploads.push_back({
+                        .cacheKey = result.cacheKey,
+                        .texture = std::move(result.texture),
+                        .nextLevel = firstLevel,
+                    });
+                }
+            }
+        } catch (const std::exception& e) {
+            qWarning("Failed to load NIF texture '%s': %s", qUtf8Printable(result.texturePath), e.what());
+        } catch (...) {
+            qWarning("Failed to load NIF texture '%s': unknown exception", qUtf8Printable(result.texturePath));
+        }
+        texture->resolve(std::move(uploaded));
+    }
+
+    // New textures get their mip tail first; the remaining budget sharpens earlier ones by one level each.
+    for (auto it = progressiveUploads.begin(); it != progressiveUploads.end() && timer.elapsed() < budget.count();) {
+        auto* const texture = shareGroup.cache.texture(it->cacheKey);
+        const auto level = it->nextLevel - 1;
+        if (!texture || !texture->isReady() || !TextureUpload::uploadLevel(*texture, it->texture.image, level)) {
+            it = progressiveUploads.erase(it);
+            continue;
+        }
+
+        it->nextLevel = level;
+        it = level == 0 ? progressiveUploads.erase(it) : std::next(it);
+    }
+
+    return decodedWaiting || !progressiveUploads.empty();
+}
+
+void TextureManager::waitForPendingLoads() {
+    textureThreadPool().waitForDone();
+}
+
+Fo4Material::Material TextureManager::getFo4Material(const QString& materialPath) const {
     const auto normalizedPath = Fo4Material::normalizeMaterialDataPath(materialPath);
     if (normalizedPath.isEmpty()) {
         return {};
     }
 
-    const auto material = Fo4Material::read(m_Loader->loadDataFile(normalizedPath));
+    auto& materialCache = Fo4MaterialCache::instance();
+    if (auto material = materialCache.find(m_SourceKey, normalizedPath)) {
+        return std::move(*material);
+    }
+
+    auto material = Fo4Material::read(m_Loader->loadDataFile(normalizedPath).bytes());
+    materialCache.insert(m_SourceKey, normalizedPath, material);
+    return material;
+}
+
+QStringList TextureManager::getFo4MaterialTextures(const QString& materialPath) const {
+    const auto material = getFo4Material(materialPath);
     return material.valid ? material.textures : QStringList {};
 }
 
 PreviewTexture* TextureManager::getErrorTexture() {
-    return m_Cache->getErrorTexture();
+    return shareGroup().cache.getErrorTexture();
 }
 
 PreviewTexture* TextureManager::getBlackTexture() {
-    return m_Cache->getBlackTexture();
+    return shareGroup().cache.getBlackTexture();
 }
 
 PreviewTexture* TextureManager::getWhiteTexture() {
-    return m_Cache->getWhiteTexture();
+    return shareGroup().cache.getWhiteTexture();
 }
 
 PreviewTexture* TextureManager::getFlatNormalTexture() {
-    return m_Cache->getFlatNormalTexture();
+    return shareGroup().cache.getFlatNormalTexture();
 }
@@ -1,38 +1,73 @@
 #pragma once
 
+#include "DataPathKey.h"
+#include "Fo4Material.h"
 #include "TextureSource.h"
 
+#include <QSet>
+#include <QString>
 #include <QStringList>
 
+#include <chrono>
 #include <memory>
 #include <string>
 
 class PreviewTexture;
-class QString;
-class TextureCache;
+class QObject;
 class TextureLoader;
+struct TextureShareGroup;
 
+// Textures are looked up in MO2 on the GUI thread, found in archives, read and decoded on a
+// worker pool, and uploaded by processUploads() on the GL thread. getTexture() hands out a
+// pending PreviewTexture that is resolved in place once its upload finishes. Uploaded textures are shared with
+// every manager whose context is in the same OpenGL share group and outlive this manager.
 class TextureManager {
 public:
-    explicit TextureManager(MOBase::IOrganizer* organizer, TextureSourceProvider textureSource = {});
+    // updateTarget receives a queued update() call whenever decoded textures are waiting for upload.
+    explicit TextureManager(
+        MOBase::IOrganizer* organizer,
+        TextureSourceProvider textureSource = {},
+        QObject* updateTarget = nullptr
+    );
     ~TextureManager();
     TextureManager(const TextureManager&) = delete;
     TextureManager(TextureManager&&) = delete;
     TextureManager& operator=(const TextureManager&) = delete;
     TextureManager& operator=(TextureManager&&) = delete;
 
+    // Releases the textures this manager used; they stay cached for other widgets until
+    // evicted. Needs the widget's context to be current.
     void cleanup();
 
+    // Queues every uncached texture as one archive batch so later getTexture() calls hit the cache.
+    void prefetchTextures(const QStringList& texturePaths);
     PreviewTexture* getTexture(const std::string& texturePath);
     PreviewTexture* getTexture(const QString& texturePath);
+    // Parsed once per texture source through Fo4MaterialCache.
+    [[nodiscard]] Fo4Material::Material getFo4Material(const QString& materialPath) const;
     [[nodiscard]] QStringList getFo4MaterialTextures(const QString& materialPath) const;
 
+    // Uploads decoded textures, then the remaining mip levels of progressive uploads, until
+    // budget is spent; returns true if more work is waiting.
+    bool processUploads(std::chrono::milliseconds budget);
+    static void waitForPendingLoads();
+
     PreviewTexture* getErrorTexture();
     PreviewTexture* getBlackTexture();
     PreviewTexture* getWhiteTexture();
     PreviewTexture* getFlatNormalTexture();
 
 private:
-    std::unique_ptr<TextureLoader> m_Loader;
-    std::unique_ptr<TextureCache> m_Cache;
+    // Attaches to the share group of the current context on first use.
+    TextureShareGroup& shareGroup();
+    void detachShareGroup();
+    [[nodiscard]] DataPathKey cacheKey(const QString& normalizedPath) const;
+    void useTexture(const DataPathKey& key);
+    void requestTextures(const QStringList& texturePaths);
+
+    QString m_SourceKey;
+    std::unique_ptr<const TextureLoader> m_Loader;
+    QObject* m_UpdateTarget = nullptr;
+    std::shared_ptr<TextureShareGroup> m_ShareGroup;
+    QSet<DataPathKey> m_UsedKeys;
 };
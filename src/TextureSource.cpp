@@ -1,6 +1,9 @@
 #include "TextureSource.h"
-#include "ArchiveAccess.h"
+#include "ArchiveIndex.h"
+#include "ArchiveIndexer.h"
+#include "DirectorySnapshots.h"
 #include "Fo4Material.h"
+#include "Fo4MaterialCache.h"
 #include "MoDataPaths.h"
 #include "NifShaderUtils.h"
 #include "ShaderClassification.h"
@@ -11,7 +14,7 @@
 
 #include <QDebug>
 #include <QDir>
-#include <QFileInfo>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSet>
@@ -25,15 +28,13 @@
 #include <uibase/iplugingame.h>
 #include <utility>
 
-#include <libbsarch/bs_archive.h>
-
 namespace {
 struct TextureProviderBuilder {
     QString sourceName;
     QString sourcePath;
     QString displayName;
     QStringList archivePaths;
-    QStringList coveredTextureKeys;
+    QSet<DataPathKey> coveredTextureKeys;
 };
 
 struct TextureSlotSummary {
@@ -47,63 +48,8 @@ void appendUnique(QStringList& values, const QString& value) {
     }
 }
 
-bool loadArchivePath(libbsarch::bs_archive& archive, const QString& archivePath) {
-    QString error;
-    if (ArchiveAccess::loadArchive(archive, archivePath, &error)) {
-        return true;
-    }
-
-    qWarning(
-        "Failed to load BSA archive '%s' while resolving texture sources: %s",
-        qUtf8Printable(archivePath),
-        qUtf8Printable(error)
-    );
-    return false;
-}
-
-bool archiveContainsTexture(libbsarch::bs_archive& archive, const QString& texturePath) {
-    QString errorPath;
-    QString error;
-    if (ArchiveAccess::containsDataPath(archive, texturePath, &errorPath, &error)) {
-        return true;
-    }
-
-    if (!errorPath.isEmpty()) {
-        qWarning(
-            "Failed to inspect BSA archive texture path '%s': %s",
-            qUtf8Printable(errorPath),
-            qUtf8Printable(error)
-        );
-    }
-
-    return false;
-}
-
-void appendArchiveCoverage(
-    QStringList& coveredTextureKeys,
-    const QStringList& archivePaths,
-    const QVector<TextureReference>& references
-) {
-    for (const auto& archivePath : archivePaths) {
-        if (coveredTextureKeys.size() >= references.size()) {
-            return;
-        }
-
-        libbsarch::bs_archive archive;
-        if (archivePath.isEmpty() || !loadArchivePath(archive, archivePath)) {
-            continue;
-        }
-
-        for (const auto& reference : references) {
-            if (coveredTextureKeys.contains(reference.key, Qt::CaseInsensitive)) {
-                continue;
-            }
-
-            if (archiveContainsTexture(archive, reference.path)) {
-                appendUnique(coveredTextureKeys, reference.key);
-            }
-        }
-    }
+bool isActiveMod(MOBase::IModList* modList, const QString& modName) {
+    return (modList->state(modName) & MOBase::IModList::STATE_ACTIVE) != 0;
 }
 
 bool gameDataContainsTexture(MOBase::IOrganizer* organizer, const QString& texturePath) {
@@ -117,12 +63,12 @@ bool gameDataContainsTexture(MOBase::IOrganizer* organizer, const QString& textu
     }
 
     const auto dataPath = game->dataDirectory().absoluteFilePath(QDir::cleanPath(texturePath));
-    return QFileInfo::exists(dataPath) && QFileInfo(dataPath).isFile();
+    return DirectorySnapshots::instance().isFile(dataPath);
 }
 
 void appendTextureReference(
     QVector<TextureReference>& references,
-    QSet<QString>& seenPaths,
+    QSet<DataPathKey>& seenPaths,
     const nifly::NiShader* shader,
     const ShaderManager::ShaderType shaderType,
     const int slot,
@@ -130,7 +76,7 @@ void appendTextureReference(
     const bool isRefractionProxy = false
 ) {
     const auto path = normalizeTextureDataPath(texturePath);
-    const auto key = textureDataPathKey(path);
+    const DataPathKey key(path);
     if (path.isEmpty()) {
         return;
     }
@@ -156,7 +102,7 @@ void appendTextureReference(
 
 void appendEffectShaderTextureReferences(
     QVector<TextureReference>& references,
-    QSet<QString>& seenPaths,
+    QSet<DataPathKey>& seenPaths,
     const nifly::BSEffectShaderProperty* effectShader,
     const ShaderManager::ShaderType shaderType
 ) {
@@ -209,7 +155,7 @@ void appendEffectShaderTextureReferences(
 
 void appendFo4MaterialTextureReference(
     QVector<TextureReference>& references,
-    QSet<QString>& seenPaths,
+    QSet<DataPathKey>& seenPaths,
     const nifly::NiShader* shader,
     const ShaderManager::ShaderType shaderType,
     const QStringList& textures,
@@ -223,21 +169,70 @@ void appendFo4MaterialTextureReference(
     appendTextureReference(references, seenPaths, shader, shaderType, slot, textures[materialIndex]);
 }
 
+QString fo4MaterialPath(const nifly::NiShader* shader, const ShaderManager::ShaderType shaderType) {
+    const auto materialPath = shaderType == ShaderManager::FO4EffectShader ? GetShaderMaterialPath(shader, ".bgem")
+                                                                           : GetShaderMaterialPath(shader, ".bgsm");
+    return materialPath.isEmpty() ? QString() : Fo4Material::normalizeMaterialDataPath(materialPath);
+}
+
+// Reads every BGSM/BGEM referenced by visible shapes in one archive batch, keyed by lowercased path.
+QHash<QString, Fo4Material::Material> readFo4Materials(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile) {
+    QStringList materialPaths;
+    for (auto* shape : nifFile->GetShapes()) {
+        if (!shape || shape->flags & TriShape::Hidden) {
+            continue;
+        }
+
+        auto* const shader = nifFile->GetShader(shape);
+        if (!shader) {
+            continue;
+        }
+
+        const auto shaderType = classifyShaderType(nifFile, shader);
+        if (shaderType == ShaderManager::FO4Default || shaderType == ShaderManager::FO4EffectShader) {
+            appendUnique(materialPaths, fo4MaterialPath(shader, shaderType));
+        }
+    }
+
+    // Coverage is computed against the Auto source, whose materials the renderer shares.
+    auto& materialCache = Fo4MaterialCache::instance();
+    const auto sourceKey = textureProviderKey(TextureSourceProvider {});
+    QHash<QString, Fo4Material::Material> materials;
+    QStringList uncachedPaths;
+    for (const auto& materialPath : materialPaths) {
+        if (auto material = materialCache.find(sourceKey, materialPath)) {
+            materials.insert(materialPath.toLower(), std::move(*material));
+        } else {
+            uncachedPaths.append(materialPath);
+        }
+    }
+    if (uncachedPaths.isEmpty()) {
+        return materials;
+    }
+
+    const TextureLoader loader(organizer);
+    const auto materialData = loader.loadDataFiles(uncachedPaths);
+    for (qsizetype i = 0; i < uncachedPaths.size(); ++i) {
+        auto material = Fo4Material::read(materialData[i].bytes());
+        materialCache.insert(sourceKey, uncachedPaths[i], material);
+        materials.insert(uncachedPaths[i].toLower(), std::move(material));
+    }
+    return materials;
+}
+
 void appendFo4MaterialTextureReferences(
     QVector<TextureReference>& references,
-    QSet<QString>& seenPaths,
-    MOBase::IOrganizer* organizer,
+    QSet<DataPathKey>& seenPaths,
+    const QHash<QString, Fo4Material::Material>& materials,
     const nifly::NiShader* shader,
     const ShaderManager::ShaderType shaderType
 ) {
-    const auto materialPath = shaderType == ShaderManager::FO4EffectShader ? GetShaderMaterialPath(shader, ".bgem")
-                                                                           : GetShaderMaterialPath(shader, ".bgsm");
+    const auto materialPath = fo4MaterialPath(shader, shaderType);
     if (materialPath.isEmpty()) {
         return;
     }
 
-    const TextureLoader loader(organizer);
-    const auto material = Fo4Material::read(loader.loadDataFile(Fo4Material::normalizeMaterialDataPath(materialPath)));
+    const auto material = materials.value(materialPath.toLower());
     if (!material.valid) {
         return;
     }
@@ -349,11 +344,12 @@ void appendFo4MaterialTextureReferences(
 
 QVector<TextureReference> textureReferencesFor(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile) {
     QVector<TextureReference> references;
-    QSet<QString> seenPaths;
+    QSet<DataPathKey> seenPaths;
     if (!nifFile) {
         return references;
     }
 
+    const auto materials = readFo4Materials(organizer, nifFile);
     for (auto* shape : nifFile->GetShapes()) {
         if (!shape || shape->flags & TriShape::Hidden) {
             continue;
@@ -368,7 +364,7 @@ QVector<TextureReference> textureReferencesFor(MOBase::IOrganizer* organizer, co
         const auto shaderType = classifyShaderType(nifFile, shader);
 
         if (shaderType == ShaderManager::FO4Default || shaderType == ShaderManager::FO4EffectShader) {
-            appendFo4MaterialTextureReferences(references, seenPaths, organizer, shader, shaderType);
+            appendFo4MaterialTextureReferences(references, seenPaths, materials, shader, shaderType);
         }
 
         if (auto* const effectShader = dynamic_cast<nifly::BSEffectShaderProperty*>(shader)) {
@@ -515,12 +511,21 @@ QStringList textureDataPathVariants(const QString& path) {
     return paths;
 }
 
-QString textureDataPathKey(const QString& path) {
-    return normalizeTextureDataPath(path).toLower();
+DataPathKey textureDataPathKey(const QString& path) {
+    return DataPathKey(normalizeTextureDataPath(path));
 }
 
 bool textureProviderCoversPath(const TextureSourceProvider& provider, const QString& texturePath) {
-    return provider.coveredTextureKeys.contains(textureDataPathKey(texturePath), Qt::CaseInsensitive);
+    return provider.coveredTextureKeys.contains(textureDataPathKey(texturePath));
+}
+
+QString textureProviderKey(const TextureSourceProvider& provider) {
+    switch (provider.kind) {
+        case TextureSourceProviderKind::Mod:      return QStringLiteral("mod:%1|").arg(provider.sourceName);
+        case TextureSourceProviderKind::GameData: return QStringLiteral("data|");
+        case TextureSourceProviderKind::Auto:     break;
+    }
+    return {};
 }
 
 TextureSourceSet TextureSourceResolver::resolve(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile) {
@@ -541,26 +546,73 @@ TextureSourceSet TextureSourceResolver::resolve(MOBase::IOrganizer* organizer, c
     auto* const modList = organizer->modList();
     QMap<QString, TextureProviderBuilder> modBuilders;
     QStringList modOrder;
-    if (modList) {
-        for (const auto& reference : sourceSet.references) {
-            const auto origins = organizer->getFileOrigins(reference.path);
-            for (const auto& modName : origins) {
-                auto* const mod = modList->getMod(modName);
-                if (!mod) {
-                    continue;
-                }
+    const auto coverModTexture = [&](const QString& modName, const DataPathKey& key) {
+        if (const auto it = modBuilders.find(modName); it != modBuilders.end()) {
+            it->coveredTextureKeys.insert(key);
+            return;
+        }
+
+        auto* const mod = modList->getMod(modName);
+        if (!mod) {
+            return;
+        }
+
+        auto& builder = modBuilders[modName];
+        modOrder.append(modName);
+        builder.sourceName = modName;
+        builder.sourcePath = QDir::fromNativeSeparators(mod->absolutePath());
+        builder.displayName = modList->displayName(modName);
+        builder.archivePaths = MoDataPaths::archivePathsFromMod(mod);
+        builder.coveredTextureKeys.insert(key);
+    };
+
+    TextureProviderBuilder gameBuilder;
+    gameBuilder.displayName = QObject::tr("Game Data");
+    gameBuilder.sourcePath = organizer->managedGame()
+                                 ? QDir::fromNativeSeparators(organizer->managedGame()->dataDirectory().absolutePath())
+                                 : QString();
+    gameBuilder.archivePaths = MoDataPaths::archivePathsFromGame(organizer);
+    const bool gameIndexed = ArchiveIndexer::ensureIndexed(ArchiveIndex::GameOwner, gameBuilder.archivePaths);
+
+    // Only owners already indexed with their current archives count; stale ones are queued
+    // and the view resolves again when the indexer reports them.
+    QHash<QString, bool> currentOwners;
+    const auto isCurrentMod = [&](const QString& modName) {
+        if (const auto it = currentOwners.constFind(modName); it != currentOwners.cend()) {
+            return it.value();
+        }
+
+        auto* const mod = modList->getMod(modName);
+        const bool current = mod
+            && isActiveMod(modList, modName)
+            && ArchiveIndexer::ensureIndexed(modName, MoDataPaths::archivePathsFromMod(mod));
+        currentOwners.insert(modName, current);
+        return current;
+    };
+
+    // One pass without touching archives: MO2's file origins cover loose files, and one
+    // archive index lookup per reference names every mod and the game whose archives hold it.
+    const auto& index = ArchiveIndex::instance();
+    for (const auto& reference : sourceSet.references) {
+        if (modList) {
+            for (const auto& modName : organizer->getFileOrigins(reference.path)) {
+                coverModTexture(modName, reference.key);
+            }
+        }
 
-                auto& builder = modBuilders[modName];
-                if (builder.sourceName.isEmpty()) {
-                    modOrder.append(modName);
-                    builder.sourceName = modName;
-                    builder.sourcePath = QDir::fromNativeSeparators(mod->absolutePath());
-                    builder.displayName = modList->displayName(modName);
-                    builder.archivePaths = MoDataPaths::archivePathsFromMod(mod);
+        for (const auto& owner : index.owners(reference.key)) {
+            if (owner == ArchiveIndex::GameOwner) {
+                if (gameIndexed) {
+                    gameBuilder.coveredTextureKeys.insert(reference.key);
                 }
-                appendUnique(builder.coveredTextureKeys, reference.key);
+            } else if (modList && isCurrentMod(owner)) {
+                coverModTexture(owner, reference.key);
             }
         }
+
+        if (gameDataContainsTexture(organizer, reference.path)) {
+            gameBuilder.coveredTextureKeys.insert(reference.key);
+        }
     }
 
     orderModsByProfilePriority(modOrder, modList);
@@ -573,19 +625,6 @@ TextureSourceSet TextureSourceResolver::resolve(MOBase::IOrganizer* organizer, c
         }
     }
 
-    TextureProviderBuilder gameBuilder;
-    gameBuilder.displayName = QObject::tr("Game Data");
-    gameBuilder.sourcePath = organizer->managedGame()
-                                 ? QDir::fromNativeSeparators(organizer->managedGame()->dataDirectory().absolutePath())
-                                 : QString();
-    gameBuilder.archivePaths = MoDataPaths::archivePathsFromGame(organizer);
-    for (const auto& reference : sourceSet.references) {
-        if (gameDataContainsTexture(organizer, reference.path)) {
-            appendUnique(gameBuilder.coveredTextureKeys, reference.key);
-        }
-    }
-    appendArchiveCoverage(gameBuilder.coveredTextureKeys, gameBuilder.archivePaths, sourceSet.references);
-
     if (!gameBuilder.coveredTextureKeys.isEmpty()) {
         sourceSet.providers.push_back(
             makeProvider(TextureSourceProviderKind::GameData, gameBuilder, sourceSet.references.size())
@@ -595,6 +634,14 @@ TextureSourceSet TextureSourceResolver::resolve(MOBase::IOrganizer* organizer, c
     return sourceSet;
 }
 
+QStringList TextureSourceResolver::texturePaths(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile) {
+    QStringList paths;
+    for (const auto& reference : textureReferencesFor(organizer, nifFile)) {
+        paths.append(reference.path);
+    }
+    return paths;
+}
+
 QString makeTextureSummaryText(const TextureSourceSet& sourceSet) {
     if (sourceSet.references.isEmpty()) {
         return QObject::tr("Textures: none");
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "DataPathKey.h"
+
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -22,7 +25,7 @@ struct TextureReference {
     int slot = 0;
     QString slotName;
     QString path;
-    QString key;
+    DataPathKey key;
 };
 
 struct TextureSourceProvider {
@@ -31,7 +34,7 @@ struct TextureSourceProvider {
     QString sourceName;
     QString sourcePath;
     QStringList archivePaths;
-    QStringList coveredTextureKeys;
+    QSet<DataPathKey> coveredTextureKeys;
     qsizetype coveredTextureCount = 0;
     qsizetype totalTextureCount = 0;
 };
@@ -44,11 +47,15 @@ struct TextureSourceSet {
 class TextureSourceResolver {
 public:
     static TextureSourceSet resolve(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile);
+    // Every texture path referenced by visible shapes, in shape order.
+    static QStringList texturePaths(MOBase::IOrganizer* organizer, const nifly::NifFile* nifFile);
 };
 
 QString makeTextureSummaryText(const TextureSourceSet& sourceSet);
 QString makeTextureToolTipText(const TextureSourceSet& sourceSet, int providerIndex);
 QString normalizeTextureDataPath(QString path);
 QStringList textureDataPathVariants(const QString& path);
-QString textureDataPathKey(const QString& path);
+DataPathKey textureDataPathKey(const QString& path);
 bool textureProviderCoversPath(const TextureSourceProvider& provider, const QString& texturePath);
+// Distinguishes per-provider cache entries for the same data path; empty for Auto.
+QString textureProviderKey(const TextureSourceProvider& provider);
@@ -1,4 +1,5 @@
 #include "TextureUpload.h"
+#include "DdsTextures.h"
 #include "OpenGLResources.h"
 #include "PreviewTexture.h"
 
@@ -11,41 +12,36 @@
 #include <QOpenGLVersionFunctionsFactory>
 #include <QtGui/qopenglext.h>
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 
 namespace {
 
-bool hasUploadableExtents(const gli::texture& texture) {
-    if (texture.levels() == 0 || texture.layers() != 1 || texture.faces() == 0) {
+bool hasUploadableExtents(const DdsImageView& texture) {
+    if (texture.levels == 0 || texture.levels > DdsImageView::MaxLevels || texture.faces == 0) {
         return false;
     }
 
-    if (texture.target() == gli::TARGET_2D && texture.faces() != 1) {
+    if (texture.target == gli::TARGET_2D && texture.faces != 1) {
         return false;
     }
-    if (texture.target() == gli::TARGET_CUBE && texture.faces() != 6) {
+    if (texture.target == gli::TARGET_CUBE && texture.faces != 6) {
         return false;
     }
 
-    for (std::size_t level = 0; level < texture.levels(); ++level) {
-        const auto extent = texture.extent(level);
-        if (extent.x
-            <= 0
-            || extent.y
-            <= 0
-            || extent.z
-            <= 0
-            || extent.x
-            > std::numeric_limits<GLsizei>::max()
-            || extent.y
-            > std::numeric_limits<GLsizei>::max()
+    for (std::size_t level = 0; level < texture.levels; ++level) {
+        if (texture.width(level)
+            > static_cast<std::uint32_t>(std::numeric_limits<GLsizei>::max())
+            || texture.height(level)
+            > static_cast<std::uint32_t>(std::numeric_limits<GLsizei>::max())
             || texture.size(level)
             > static_cast<std::size_t>(std::numeric_limits<GLsizei>::max())) {
             return false;
         }
     }
 
-    return texture.levels() <= static_cast<std::size_t>(std::numeric_limits<GLsizei>::max());
+    return true;
 }
 
 PFNGLTEXSTORAGE2DPROC resolveTexStorage2D(const QOpenGLContext* context) {
@@ -56,8 +52,8 @@ void clearGlErrors(QOpenGLFunctions_2_1* f) {
     while (f->glGetError() != GL_NO_ERROR) {}
 }
 
-GLenum textureFaceTarget(const gli::texture& texture, const GLenum target, const std::size_t face) {
-    return gli::is_target_cube(texture.target()) ? static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : target;
+GLenum textureFaceTarget(const DdsImageView& texture, const GLenum target, const std::size_t face) {
+    return gli::is_target_cube(texture.target) ? static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : target;
 }
 
 GLenum textureUploadTarget(const gli::target target) {
@@ -90,91 +86,174 @@ void setTextureParameters(
     f->glTexParameteri(target, static_cast<GLenum>(QOpenGLTexture::SwizzleAlpha), format.Swizzles[3]);
 }
 
-GLenum uploadTextureData(
-    const gli::texture& texture,
+struct UploadContext {
+    QOpenGLFunctions_2_1* f = nullptr;
+    PFNGLTEXSTORAGE2DPROC glTexStorage2D = nullptr;
+    GLenum target = 0;
+    gli::gl::format format;
+};
+
+std::optional<UploadContext> prepareUpload(const DdsImageView& texture) {
+    if (texture.empty()) {
+        return std::nullopt;
+    }
+
+    if (!hasUploadableExtents(texture)) {
+        qWarning("Skipping DDS texture with invalid or unsupported image layout");
+        return std::nullopt;
+    }
+
+    auto* context = QOpenGLContext::currentContext();
+    auto* f = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_2_1>(context);
+    if (!f) {
+        qWarning("Skipping DDS texture: OpenGL 2.1 functions unavailable");
+        return std::nullopt;
+    }
+
+    const auto target = textureUploadTarget(texture.target);
+    if (target == 0) {
+        qWarning("Skipping DDS texture with unsupported OpenGL texture target");
+        return std::nullopt;
+    }
+
+    const gli::gl gl(gli::gl::PROFILE_GL33);
+    return UploadContext {
+        .f = f,
+        .glTexStorage2D = resolveTexStorage2D(context),
+        .target = target,
+        .format = gl.translate(
+            texture.format,
+            gli::swizzles(gli::SWIZZLE_RED, gli::SWIZZLE_GREEN, gli::SWIZZLE_BLUE, gli::SWIZZLE_ALPHA)
+        ),
+    };
+}
+
+std::size_t imageByteSize(const DdsImageView& texture) {
+    std::size_t byteSize = 0;
+    for (std::size_t level = 0; level < texture.levels; ++level) {
+        byteSize += texture.size(level);
+    }
+    return byteSize * texture.faces;
+}
+
+// The first level of the mip tail that is uploaded up front by a progressive upload.
+std::size_t progressiveFirstLevel(const DdsImageView& texture) {
+    for (std::size_t level = 0; level < texture.levels; ++level) {
+        if (std::max(texture.width(level), texture.height(level)) <= TextureUpload::ProgressiveTailSize) {
+            return level;
+        }
+    }
+    return texture.levels - 1;
+}
+
+void uploadTextureLevel(
+    const DdsImageView& texture,
     QOpenGLFunctions_2_1* f,
-    PFNGLTEXSTORAGE2DPROC glTexStorage2D,
     const GLenum target,
     const gli::gl::format& format,
-    const bool useStorage
+    const bool useStorage,
+    const std::size_t level
 ) {
-    if (useStorage) {
-        const auto extent = texture.extent();
-        glTexStorage2D(target, static_cast<GLsizei>(texture.levels()), format.Internal, extent.x, extent.y);
-    }
-
-    for (std::size_t face = 0; face < texture.faces(); ++face) {
-        for (std::size_t level = 0; level < texture.levels(); ++level) {
-            const auto extent = texture.extent(level);
-            const auto targetFace = textureFaceTarget(texture, target, face);
-            const auto* textureData = texture.data(0, face, level);
-            const auto textureSize = static_cast<GLsizei>(texture.size(level));
-
-            if (gli::is_compressed(texture.format())) {
-                if (useStorage) {
-                    f->glCompressedTexSubImage2D(
-                        targetFace,
-                        static_cast<GLint>(level),
-                        0,
-                        0,
-                        extent.x,
-                        extent.y,
-                        format.Internal,
-                        textureSize,
-                        textureData
-                    );
-                } else {
-                    f->glCompressedTexImage2D(
-                        targetFace,
-                        static_cast<GLint>(level),
-                        format.Internal,
-                        extent.x,
-                        extent.y,
-                        0,
-                        textureSize,
-                        textureData
-                    );
-                }
-            } else if (useStorage) {
-                f->glTexSubImage2D(
+    for (std::size_t face = 0; face < texture.faces; ++face) {
+        const auto width = static_cast<GLsizei>(texture.width(level));
+        const auto height = static_cast<GLsizei>(texture.height(level));
+        const auto targetFace = textureFaceTarget(texture, target, face);
+        const auto* textureData = texture.data(face, level);
+        const auto textureSize = static_cast<GLsizei>(texture.size(level));
+
+        if (gli::is_compressed(texture.format)) {
+            if (useStorage) {
+                f->glCompressedTexSubImage2D(
                     targetFace,
                     static_cast<GLint>(level),
                     0,
                     0,
-                    extent.x,
-                    extent.y,
-                    format.External,
-                    format.Type,
+                    width,
+                    height,
+                    format.Internal,
+                    textureSize,
                     textureData
                 );
             } else {
-                f->glTexImage2D(
+                f->glCompressedTexImage2D(
                     targetFace,
                     static_cast<GLint>(level),
                     format.Internal,
-                    extent.x,
-                    extent.y,
+                    width,
+                    height,
                     0,
-                    format.External,
-                    format.Type,
+                    textureSize,
                     textureData
                 );
             }
+        } else if (useStorage) {
+            f->glTexSubImage2D(
+                targetFace,
+                static_cast<GLint>(level),
+                0,
+                0,
+                width,
+                height,
+                format.External,
+                format.Type,
+                textureData
+            );
+        } else {
+            f->glTexImage2D(
+                targetFace,
+                static_cast<GLint>(level),
+                format.Internal,
+                width,
+                height,
+                0,
+                format.External,
+                format.Type,
+                textureData
+            );
         }
     }
-
-    return f->glGetError();
 }
 
-OpenGLTextureResource makeRawTexture(
-    const gli::texture& texture,
+GLenum uploadTextureData(
+    const DdsImageView& texture,
     QOpenGLFunctions_2_1* f,
+    PFNGLTEXSTORAGE2DPROC glTexStorage2D,
     const GLenum target,
     const gli::gl::format& format,
-    PFNGLTEXSTORAGE2DPROC glTexStorage2D
+    const bool useStorage,
+    const std::size_t firstLevel
 ) {
+    if (useStorage) {
+        glTexStorage2D(
+            target,
+            static_cast<GLsizei>(texture.levels),
+            format.Internal,
+            static_cast<GLsizei>(texture.baseWidth),
+            static_cast<GLsizei>(texture.baseHeight)
+        );
+    }
+
+    // Smallest levels first so a progressive upload can sample the tail right away.
+    for (auto level = texture.levels; level-- > firstLevel;) {
+        uploadTextureLevel(texture, f, target, format, useStorage, level);
+    }
+    if (firstLevel > 0) {
+        f->glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(firstLevel));
+    }
+
+    return f->glGetError();
+}
+
+OpenGLTextureResource makeRawTexture(
+    const DdsImageView& texture,
+    const UploadContext& context,
+    const std::size_t firstLevel
+) {
+    auto* const f = context.f;
+    const auto target = context.target;
     for (const bool useStorage : {true, false}) {
-        if (useStorage && !glTexStorage2D) {
+        // Mutable textures cannot be filled level by level without becoming incomplete.
+        if ((useStorage && !context.glTexStorage2D) || (!useStorage && firstLevel > 0)) {
             continue;
         }
 
@@ -186,11 +265,19 @@ OpenGLTextureResource makeRawTexture(
 
         OpenGLTextureResource textureResource(textureId, target);
         f->glBindTexture(target, textureResource.id());
-        setTextureParameters(f, target, format, texture.levels());
+        setTextureParameters(f, target, context.format, texture.levels);
         clearGlErrors(f);
         f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        const auto error = uploadTextureData(texture, f, glTexStorage2D, target, format, useStorage);
+        const auto error = uploadTextureData(
+            texture,
+            f,
+            context.glTexStorage2D,
+            target,
+            context.format,
+            useStorage,
+            firstLevel
+        );
 
         f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         f->glBindTexture(target, 0);
@@ -212,38 +299,61 @@ OpenGLTextureResource makeRawTexture(
 
 } // namespace
 
-std::unique_ptr<PreviewTexture> TextureUpload::upload(const gli::texture& texture) {
-    if (texture.empty()) {
+std::unique_ptr<PreviewTexture> TextureUpload::upload(const DdsImageView& texture) {
+    const auto context = prepareUpload(texture);
+    if (!context) {
         return nullptr;
     }
 
-    if (!hasUploadableExtents(texture)) {
-        qWarning("Skipping DDS texture with invalid or unsupported image layout");
+    auto textureResource = makeRawTexture(texture, *context, 0);
+    if (!textureResource) {
+        qWarning("Skipping DDS texture after failed OpenGL upload");
         return nullptr;
     }
 
-    auto* context = QOpenGLContext::currentContext();
-    auto* f = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_2_1>(context);
-    if (!f) {
-        qWarning("Skipping DDS texture: OpenGL 2.1 functions unavailable");
-        return nullptr;
-    }
+    return std::make_unique<PreviewTexture>(textureResource.release(), context->target, imageByteSize(texture));
+}
 
-    const gli::gl gl(gli::gl::PROFILE_GL33);
-    const auto format = gl.translate(texture.format(), texture.swizzles());
-    const auto target = textureUploadTarget(texture.target());
-    if (target == 0) {
-        qWarning("Skipping DDS texture with unsupported OpenGL texture target");
+std::unique_ptr<PreviewTexture> TextureUpload::beginProgressive(const DdsImageView& texture, std::size_t& firstLevel) {
+    const auto context = prepareUpload(texture);
+    if (!context || !context->glTexStorage2D) {
         return nullptr;
     }
 
-    auto textureResource = makeRawTexture(texture, f, target, format, resolveTexStorage2D(context));
+    firstLevel = progressiveFirstLevel(texture);
+    auto textureResource = makeRawTexture(texture, *context, firstLevel);
     if (!textureResource) {
-        qWarning("Skipping DDS texture after failed OpenGL upload");
         return nullptr;
     }
 
-    return std::make_unique<PreviewTexture>(textureResource.release(), target);
+    return std::make_unique<PreviewTexture>(textureResource.release(), context->target, imageByteSize(texture));
+}
+
+bool TextureUpload::uploadLevel(const PreviewTexture& texture, const DdsImageView& image, const std::size_t level) {
+    const auto& resource = texture.rawTexture();
+    const auto context = prepareUpload(image);
+    if (!context || !resource || level >= image.levels) {
+        return false;
+    }
+
+    auto* const f = context->f;
+    f->glBindTexture(resource.target(), resource.id());
+    clearGlErrors(f);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uploadTextureLevel(image, f, resource.target(), context->format, true, level);
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Sampling only moves to the new level once it is known to be filled.
+    const auto error = f->glGetError();
+    if (error == GL_NO_ERROR) {
+        f->glTexParameteri(resource.target(), GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level));
+    }
+    f->glBindTexture(resource.target(), 0);
+
+    if (error != GL_NO_ERROR) {
+        qWarning("Failed to upload DDS texture level %zu: OpenGL error 0x%x", level, error);
+        return false;
+    }
+    return true;
 }
 
 std::unique_ptr<PreviewTexture> TextureUpload::makeSolidColor(const QVector4D color) {
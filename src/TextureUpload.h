@@ -1,16 +1,25 @@
 #pragma once
 
-#include <gli/gli.hpp>
-
 #include <QVector4D>
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 class PreviewTexture;
+struct DdsImageView;
 
 namespace TextureUpload {
 
-[[nodiscard]] std::unique_ptr<PreviewTexture> upload(const gli::texture& texture);
+// Levels no larger than this are uploaded up front by a progressive upload.
+inline constexpr std::uint32_t ProgressiveTailSize = 256;
+
+[[nodiscard]] std::unique_ptr<PreviewTexture> upload(const DdsImageView& texture);
+// Allocates immutable storage, uploads the mip tail from firstLevel down and samples only that.
+// Sharpen it with uploadLevel(firstLevel - 1) ... uploadLevel(0). Returns nullptr without
+// glTexStorage2D; callers then fall back to upload().
+[[nodiscard]] std::unique_ptr<PreviewTexture> beginProgressive(const DdsImageView& texture, std::size_t& firstLevel);
+bool uploadLevel(const PreviewTexture& texture, const DdsImageView& image, std::size_t level);
 [[nodiscard]] std::unique_ptr<PreviewTexture> makeSolidColor(QVector4D color);
 
 } // namespace TextureUpload
@@ -0,0 +1,597 @@
+#include "BethesdaArchive.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QVector>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <span>
+
+#include <zlib.h>
+
+namespace {
+constexpr std::uint32_t BsaIncludeDirectoryNames = 0x1;
+constexpr std::uint32_t BsaIncludeFileNames = 0x2;
+constexpr std::uint32_t BsaCompressedByDefault = 0x4;
+constexpr std::uint32_t BsaEmbedFileNames = 0x100;
+constexpr std::uint32_t BsaCompressionToggle = 0x40000000;
+constexpr std::uint32_t DxgiFormatBc1 = 71;
+constexpr qsizetype DdsHeaderBytes = 148;
+
+// A record to store in a fixture archive; paths are lowercase and backslash-separated.
+struct FixtureFile {
+    QByteArray path;
+    QByteArray data;
+    bool compressed = false;
+};
+
+class ByteWriter final {
+public:
+    template <class T>
+    void put(const T value) {
+        m_Bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void append(const QByteArray& bytes) {
+        m_Bytes.append(bytes);
+    }
+    template <class T>
+    void patch(const qsizetype position, const T value) {
+        std::memcpy(m_Bytes.data() + position, &value, sizeof(T));
+    }
+    [[nodiscard]] qsizetype size() const {
+        return m_Bytes.size();
+    }
+    [[nodiscard]] const QByteArray& bytes() const {
+        return m_Bytes;
+    }
+
+private:
+    QByteArray m_Bytes;
+};
+
+struct PathParts {
+    QByteArray folder;
+    QByteArray stem;
+    QByteArray extension;
+};
+
+PathParts splitPath(const QByteArray& path) {
+    const auto slash = path.lastIndexOf('\\');
+    const auto name = path.mid(slash + 1);
+    const auto dot = name.lastIndexOf('.');
+    return {
+        .folder = slash < 0 ? QByteArray() : path.left(slash),
+        .stem = dot < 0 ? name : name.left(dot),
+        .extension = dot < 0 ? QByteArray() : name.mid(dot),
+    };
+}
+
+// Hashes as written by the game's archive tools, independent of the reader's lookup code.
+std::uint32_t bsaStringHash(const QByteArray& text) {
+    std::uint32_t hash = 0;
+    for (const auto character : text) {
+        hash = hash * 0x1003F + static_cast<unsigned char>(character);
+    }
+    return hash;
+}
+
+std::uint64_t bsaHash(const QByteArray& stem, const QByteArray& extension) {
+    const auto length = static_cast<std::uint32_t>(stem.size());
+    const auto byte = [&](const qsizetype index) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(stem[index]));
+    };
+
+    std::uint32_t low = 0;
+    if (length > 0) {
+        low = byte(length - 1) | (length > 2 ? byte(length - 2) << 8 : 0) | length << 16 | byte(0) << 24;
+    }
+    if (extension == ".kf") {
+        low |= 0x80;
+    } else if (extension == ".nif") {
+        low |= 0x8000;
+    } else if (extension == ".dds") {
+        low |= 0x8080;
+    } else if (extension == ".wav") {
+        low |= 0x80000000;
+    }
+
+    const auto middle = length > 3 ? bsaStringHash(stem.mid(1, length - 3)) : 0;
+    const std::uint32_t high = middle + bsaStringHash(extension);
+    return static_cast<std::uint64_t>(high) << 32 | low;
+}
+
+std::uint32_t ba2Hash(const QByteArray& text) {
+    std::uint32_t hash = 0;
+    for (const auto character : text) {
+        hash ^= static_cast<unsigned char>(character);
+        for (int bit = 0; bit < 8; ++bit) {
+            hash = (hash & 1) ? (hash >> 1) ^ 0xEDB88320 : hash >> 1;
+        }
+    }
+    return hash;
+}
+
+std::array<char, 4> ba2Extension(const QByteArray& extension) {
+    std::array<char, 4> bytes {};
+    const auto name = extension.mid(1);
+    std::copy_n(name.constData(), std::min<qsizetype>(name.size(), 4), bytes.begin());
+    return bytes;
+}
+
+QByteArray zlibCompress(const QByteArray& data) {
+    auto length = compressBound(static_cast<uLong>(data.size()));
+    QByteArray compressed(static_cast<qsizetype>(length), Qt::Uninitialized);
+    const auto result = compress(
+        reinterpret_cast<Bytef*>(compressed.data()),
+        &length,
+        reinterpret_cast<const Bytef*>(data.constData()),
+        static_cast<uLong>(data.size())
+    );
+    compressed.resize(result == Z_OK ? static_cast<qsizetype>(length) : 0);
+    return compressed;
+}
+
+// One LZ4 frame holding a single literals-only block, which every LZ4 decoder must accept.
+QByteArray lz4Frame(const QByteArray& data) {
+    QByteArray block;
+    auto literals = data.size();
+    block.append(static_cast<char>(std::min<qsizetype>(literals, 15) << 4));
+    if (literals >= 15) {
+        for (literals -= 15; literals >= 255; literals -= 255) {
+            block.append(static_cast<char>(255));
+        }
+        block.append(static_cast<char>(literals));
+    }
+    block.append(data);
+
+    ByteWriter frame;
+    frame.put<std::uint32_t>(0x184D2204);
+    frame.put<std::uint8_t>(0x60);
+    frame.put<std::uint8_t>(0x40);
+    frame.put<std::uint8_t>(0);
+    frame.put<std::uint32_t>(static_cast<std::uint32_t>(block.size()));
+    frame.append(block);
+    frame.put<std::uint32_t>(0);
+    return frame.bytes();
+}
+
+QByteArray makeBsa(const std::uint32_t version, const std::uint32_t flags, const QVector<FixtureFile>& files) {
+    struct Folder {
+        QByteArray name;
+        std::map<std::uint64_t, FixtureFile> files;
+    };
+
+    std::map<std::uint64_t, Folder> folders;
+    std::uint32_t folderNameBytes = 0;
+    std::uint32_t fileNameBytes = 0;
+    for (const auto& file : files) {
+        const auto parts = splitPath(file.path);
+        auto& folder = folders[bsaHash(parts.folder, {})];
+        if (folder.name.isEmpty()) {
+            folder.name = parts.folder;
+            folderNameBytes += static_cast<std::uint32_t>(parts.folder.size()) + 1;
+        }
+        folder.files[bsaHash(parts.stem, parts.extension)] = file;
+        fileNameBytes += static_cast<std::uint32_t>(parts.stem.size() + parts.extension.size()) + 1;
+    }
+
+    const bool skyrimSE = version == 105;
+    const qsizetype folderStride = skyrimSE ? 24 : 16;
+    ByteWriter out;
+    out.append(QByteArray("BSA\0", 4));
+    out.put<std::uint32_t>(version);
+    out.put<std::uint32_t>(36);
+    out.put<std::uint32_t>(flags);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(folders.size()));
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(files.size()));
+    out.put<std::uint32_t>(folderNameBytes);
+    out.put<std::uint32_t>(fileNameBytes);
+    out.put<std::uint32_t>(0);
+
+    const auto folderRecords = out.size();
+    for (const auto& [hash, folder] : folders) {
+        out.put<std::uint64_t>(hash);
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(folder.files.size()));
+        if (skyrimSE) {
+            out.put<std::uint32_t>(0);
+            out.put<std::uint64_t>(0);
+        } else {
+            out.put<std::uint32_t>(0);
+        }
+    }
+
+    // Folder offsets count the file name block, which the game stores after all records.
+    QVector<std::pair<qsizetype, FixtureFile>> fileRecords;
+    qsizetype folderIndex = 0;
+    for (const auto& [hash, folder] : folders) {
+        const auto offsetField = folderRecords + folderStride * folderIndex++ + (skyrimSE ? 16 : 12);
+        const auto blockOffset = static_cast<std::uint64_t>(out.size()) + fileNameBytes;
+        if (skyrimSE) {
+            out.patch<std::uint64_t>(offsetField, blockOffset);
+        } else {
+            out.patch<std::uint32_t>(offsetField, static_cast<std::uint32_t>(blockOffset));
+        }
+
+        out.put<std::uint8_t>(static_cast<std::uint8_t>(folder.name.size() + 1));
+        out.append(folder.name);
+        out.put<char>('\0');
+        for (const auto& [fileHash, file] : folder.files) {
+            fileRecords.append({out.size(), file});
+            out.put<std::uint64_t>(fileHash);
+            out.put<std::uint32_t>(0);
+            out.put<std::uint32_t>(0);
+        }
+    }
+
+    for (const auto& [record, file] : fileRecords) {
+        const auto parts = splitPath(file.path);
+        out.append(parts.stem + parts.extension);
+        out.put<char>('\0');
+    }
+
+    for (const auto& [record, file] : fileRecords) {
+        ByteWriter stored;
+        if ((flags & BsaEmbedFileNames) != 0) {
+            stored.put<std::uint8_t>(static_cast<std::uint8_t>(file.path.size()));
+            stored.append(file.path);
+        }
+        if (file.compressed) {
+            stored.put<std::uint32_t>(static_cast<std::uint32_t>(file.data.size()));
+            stored.append(skyrimSE ? lz4Frame(file.data) : zlibCompress(file.data));
+        } else {
+            stored.append(file.data);
+        }
+
+        const bool toggled = file.compressed != ((flags & BsaCompressedByDefault) != 0);
+        out.patch<std::uint32_t>(
+            record + 8,
+            static_cast<std::uint32_t>(stored.size()) | (toggled ? BsaCompressionToggle : 0)
+        );
+        out.patch<std::uint32_t>(record + 12, static_cast<std::uint32_t>(out.size()));
+        out.append(stored.bytes());
+    }
+    return out.bytes();
+}
+
+void putBa2Header(ByteWriter& out, const char* type, const qsizetype fileCount) {
+    out.append("BTDX");
+    out.put<std::uint32_t>(1);
+    out.append(type);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(fileCount));
+    out.put<std::uint64_t>(0);
+}
+
+void putBa2Key(ByteWriter& out, const QByteArray& path) {
+    const auto parts = splitPath(path);
+    const auto extension = ba2Extension(parts.extension);
+    out.put<std::uint32_t>(ba2Hash(parts.stem));
+    out.append(QByteArray(extension.data(), 4));
+    out.put<std::uint32_t>(ba2Hash(parts.folder));
+}
+
+void putBa2Names(ByteWriter& out, const QVector<QByteArray>& paths) {
+    out.patch<std::uint64_t>(16, static_cast<std::uint64_t>(out.size()));
+    for (const auto& path : paths) {
+        out.put<std::uint16_t>(static_cast<std::uint16_t>(path.size()));
+        out.append(path);
+    }
+}
+
+QByteArray makeGeneralBa2(const QVector<FixtureFile>& files) {
+    ByteWriter out;
+    putBa2Header(out, "GNRL", files.size());
+
+    QVector<qsizetype> records;
+    QVector<QByteArray> paths;
+    for (const auto& file : files) {
+        putBa2Key(out, file.path);
+        out.put<std::uint32_t>(0);
+        records.append(out.size());
+        out.put<std::uint64_t>(0);
+        out.put<std::uint32_t>(0);
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(file.data.size()));
+        out.put<std::uint32_t>(0xBAADF00D);
+        paths.append(file.path);
+    }
+
+    for (qsizetype i = 0; i < files.size(); ++i) {
+        const auto stored = files[i].compressed ? zlibCompress(files[i].data) : files[i].data;
+        out.patch<std::uint64_t>(records[i], static_cast<std::uint64_t>(out.size()));
+        out.patch<std::uint32_t>(records[i] + 8, files[i].compressed ? static_cast<std::uint32_t>(stored.size()) : 0);
+        out.append(stored);
+    }
+    putBa2Names(out, paths);
+    return out.bytes();
+}
+
+// One 2D texture whose mip levels are split into chunks; compressed chunks use zlib.
+QByteArray makeTextureBa2(
+    const QByteArray& path,
+    const std::uint16_t width,
+    const std::uint16_t height,
+    const QVector<FixtureFile>& chunks
+) {
+    ByteWriter out;
+    putBa2Header(out, "DX10", 1);
+    putBa2Key(out, path);
+    out.put<std::uint8_t>(0);
+    out.put<std::uint8_t>(static_cast<std::uint8_t>(chunks.size()));
+    out.put<std::uint16_t>(24);
+    out.put<std::uint16_t>(height);
+    out.put<std::uint16_t>(width);
+    out.put<std::uint8_t>(static_cast<std::uint8_t>(chunks.size()));
+    out.put<std::uint8_t>(static_cast<std::uint8_t>(DxgiFormatBc1));
+    out.put<std::uint16_t>(0);
+
+    QVector<qsizetype> records;
+    for (qsizetype mip = 0; mip < chunks.size(); ++mip) {
+        records.append(out.size());
+        out.put<std::uint64_t>(0);
+        out.put<std::uint32_t>(0);
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(chunks[mip].data.size()));
+        out.put<std::uint16_t>(static_cast<std::uint16_t>(mip));
+        out.put<std::uint16_t>(static_cast<std::uint16_t>(mip));
+        out.put<std::uint32_t>(0xBAADF00D);
+    }
+
+    for (qsizetype i = 0; i < chunks.size(); ++i) {
+        const auto stored = chunks[i].compressed ? zlibCompress(chunks[i].data) : chunks[i].data;
+        out.patch<std::uint64_t>(records[i], static_cast<std::uint64_t>(out.size()));
+        out.patch<std::uint32_t>(records[i] + 8, chunks[i].compressed ? static_cast<std::uint32_t>(stored.size()) : 0);
+        out.append(stored);
+    }
+    putBa2Names(out, {path});
+    return out.bytes();
+}
+
+QByteArray readRecord(const BethesdaArchive& archive, const QString& dataPath) {
+    const auto entry = archive.find(dataPath);
+    if (!entry) {
+        return {};
+    }
+
+    QByteArray bytes(static_cast<qsizetype>(entry->size), Qt::Uninitialized);
+    QString error;
+    if (!archive.read(*entry, std::span(bytes.data(), static_cast<std::size_t>(bytes.size())), &error)) {
+        qWarning("Failed to read '%s': %s", qUtf8Printable(dataPath), qUtf8Printable(error));
+        return {};
+    }
+    return bytes;
+}
+
+QSet<QString> listedPaths(const std::vector<BethesdaArchiveFile>& files) {
+    QSet<QString> paths;
+    for (const auto& file : files) {
+        paths.insert(file.path);
+    }
+    return paths;
+}
+
+std::uint32_t loadUint32(const QByteArray& bytes, const qsizetype offset) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, bytes.constData() + offset, sizeof(value));
+    return value;
+}
+} // namespace
+
+class BethesdaArchiveTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void readsFallout3Bsa();
+    void readsSkyrimSEBsa();
+    void readsGeneralBa2();
+    void readsTextureBa2();
+    void rejectsMalformedArchives();
+
+private:
+    [[nodiscard]] QString writeArchive(const QString& name, const QByteArray& bytes) const;
+
+    QTemporaryDir m_Directory;
+};
+
+QString BethesdaArchiveTest::writeArchive(const QString& name, const QByteArray& bytes) const {
+    const auto path = m_Directory.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size()) {
+        qWarning("Failed to write fixture '%s'", qUtf8Printable(path));
+    }
+    return path;
+}
+
+void BethesdaArchiveTest::readsFallout3Bsa() {
+    const QByteArray mesh("NIF mesh data");
+    const auto diffuse = QByteArray(300, 'd') + QByteArray("diffuse");
+    const QByteArray normal("normal map");
+    const auto path = writeArchive(
+        QStringLiteral("Fallout3.bsa"),
+        makeBsa(
+            104,
+            BsaIncludeDirectoryNames | BsaIncludeFileNames,
+            {
+                {.path = "meshes\\clutter\\bucket.nif", .data = mesh, .compressed = false},
+                {.path = "textures\\clutter\\bucket.dds", .data = diffuse, .compressed = true},
+                {.path = "textures\\clutter\\bucket_n.dds", .data = normal, .compressed = false},
+            }
+        )
+    );
+
+    QString error;
+    const auto archive = BethesdaArchive::open(path, &error);
+    QVERIFY2(archive, qPrintable(error));
+
+    const auto diffuseEntry = archive->find(QStringLiteral("Textures/Clutter/Bucket.dds"));
+    QVERIFY(diffuseEntry);
+    QVERIFY(diffuseEntry->compressed);
+    QCOMPARE(diffuseEntry->size, static_cast<std::uint32_t>(diffuse.size()));
+    QCOMPARE(readRecord(*archive, QStringLiteral("textures\\clutter\\bucket.dds")), diffuse);
+    QCOMPARE(readRecord(*archive, QStringLiteral("\\textures\\clutter\\bucket_n.dds")), normal);
+
+    const auto meshEntry = archive->find(QStringLiteral("meshes/clutter/bucket.nif"));
+    QVERIFY(meshEntry);
+    QVERIFY(!meshEntry->compressed);
+    const auto mapped = archive->mappedBytes(*meshEntry);
+    QCOMPARE(QByteArray(mapped.data(), static_cast<qsizetype>(mapped.size())), mesh);
+
+    QVERIFY(!archive->find(QStringLiteral("textures/clutter/bucket_s.dds")));
+    QVERIFY(!archive->find(QStringLiteral("textures/bucket.dds")));
+
+    const auto files = archive->files(&error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(
+        listedPaths(files),
+        QSet<QString>({
+            QStringLiteral("meshes\\clutter\\bucket.nif"),
+            QStringLiteral("textures\\clutter\\bucket.dds"),
+            QStringLiteral("textures\\clutter\\bucket_n.dds"),
+        })
+    );
+    for (const auto& file : files) {
+        const auto entry = archive->find(file.path);
+        QVERIFY(entry);
+        QCOMPARE(file.entry.compressed, entry->compressed);
+    }
+}
+
+void BethesdaArchiveTest::readsSkyrimSEBsa() {
+    const auto compressed = QByteArray(600, 'c') + QByteArray("lz4 frame");
+    const QByteArray stored("stored despite the archive default");
+    const auto path = writeArchive(
+        QStringLiteral("SkyrimSE.bsa"),
+        makeBsa(
+            105,
+            BsaIncludeDirectoryNames | BsaIncludeFileNames | BsaCompressedByDefault | BsaEmbedFileNames,
+            {
+                {.path = "meshes\\armor\\cuirass.nif", .data = compressed, .compressed = true},
+                {.path = "meshes\\armor\\cuirass_1.nif", .data = stored, .compressed = false},
+                {.path = "textures\\armor\\cuirass.dds", .data = stored, .compressed = false},
+            }
+        )
+    );
+
+    QString error;
+    const auto archive = BethesdaArchive::open(path, &error);
+    QVERIFY2(archive, qPrintable(error));
+
+    // Embedded names precede the data and are not part of the record.
+    QCOMPARE(readRecord(*archive, QStringLiteral("meshes/armor/cuirass.nif")), compressed);
+    QCOMPARE(readRecord(*archive, QStringLiteral("meshes/armor/cuirass_1.nif")), stored);
+    QCOMPARE(readRecord(*archive, QStringLiteral("textures/armor/cuirass.dds")), stored);
+
+    const auto storedEntry = archive->find(QStringLiteral("meshes/armor/cuirass_1.nif"));
+    QVERIFY(storedEntry);
+    QVERIFY(!storedEntry->compressed);
+    QCOMPARE(storedEntry->size, static_cast<std::uint32_t>(stored.size()));
+
+    QCOMPARE(archive->files(&error).size(), std::size_t {3});
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+}
+
+void BethesdaArchiveTest::readsGeneralBa2() {
+    const QByteArray material("BGSM material");
+    const auto mesh = QByteArray(400, 'm') + QByteArray("zlib mesh");
+    const auto path = writeArchive(
+        QStringLiteral("Fallout4 - Main.ba2"),
+        makeGeneralBa2({
+            {.path = "materials\\armor\\plate.bgsm", .data = material, .compressed = false},
+            {.path = "meshes\\armor\\plate.nif", .data = mesh, .compressed = true},
+        })
+    );
+
+    QString error;
+    const auto archive = BethesdaArchive::open(path, &error);
+    QVERIFY2(archive, qPrintable(error));
+
+    QCOMPARE(readRecord(*archive, QStringLiteral("Meshes/Armor/Plate.nif")), mesh);
+    QCOMPARE(readRecord(*archive, QStringLiteral("materials/armor/plate.bgsm")), material);
+    QVERIFY(!archive->find(QStringLiteral("materials/armor/plate.bgem")));
+
+    const auto materialEntry = archive->find(QStringLiteral("materials/armor/plate.bgsm"));
+    QVERIFY(materialEntry);
+    const auto mapped = archive->mappedBytes(*materialEntry);
+    QCOMPARE(QByteArray(mapped.data(), static_cast<qsizetype>(mapped.size())), material);
+
+    // BA2 listings carry record sizes directly.
+    const auto files = archive->files(&error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(files.size(), std::size_t {2});
+    for (const auto& file : files) {
+        const bool isMesh = file.path == QStringLiteral("meshes\\armor\\plate.nif");
+        QCOMPARE(file.entry.size, static_cast<std::uint32_t>(isMesh ? mesh.size() : material.size()));
+        QCOMPARE(file.entry.compressed, isMesh);
+    }
+}
+
+void BethesdaArchiveTest::readsTextureBa2() {
+    const auto largeMip = QByteArray(64, 'a');
+    const auto smallMip = QByteArray(16, 'b');
+    const auto path = writeArchive(
+        QStringLiteral("Fallout4 - Textures1.ba2"),
+        makeTextureBa2(
+            "textures\\armor\\plate_d.dds",
+            16,
+            8,
+            {
+                {.path = {}, .data = largeMip, .compressed = true},
+                {.path = {}, .data = smallMip, .compressed = false},
+            }
+        )
+    );
+
+    QString error;
+    const auto archive = BethesdaArchive::open(path, &error);
+    QVERIFY2(archive, qPrintable(error));
+
+    const auto entry = archive->find(QStringLiteral("textures/armor/plate_d.dds"));
+    QVERIFY(entry);
+    QCOMPARE(entry->size, static_cast<std::uint32_t>(DdsHeaderBytes + largeMip.size() + smallMip.size()));
+    QVERIFY(archive->mappedBytes(*entry).empty());
+
+    // The reader rebuilds a DX10 DDS header in front of the concatenated chunks.
+    const auto dds = readRecord(*archive, QStringLiteral("textures/armor/plate_d.dds"));
+    QCOMPARE(dds.size(), static_cast<qsizetype>(entry->size));
+    QCOMPARE(dds.left(4), QByteArray("DDS "));
+    QCOMPARE(loadUint32(dds, 12), std::uint32_t {8});
+    QCOMPARE(loadUint32(dds, 16), std::uint32_t {16});
+    QCOMPARE(loadUint32(dds, 28), std::uint32_t {2});
+    QCOMPARE(dds.mid(84, 4), QByteArray("DX10"));
+    QCOMPARE(loadUint32(dds, 128), DxgiFormatBc1);
+    QCOMPARE(dds.mid(DdsHeaderBytes), largeMip + smallMip);
+
+    const auto files = archive->files(&error);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QCOMPARE(files.size(), std::size_t {1});
+    QCOMPARE(files.front().path, QStringLiteral("textures\\armor\\plate_d.dds"));
+    QCOMPARE(files.front().entry.size, entry->size);
+}
+
+void BethesdaArchiveTest::rejectsMalformedArchives() {
+    QString error;
+    QVERIFY(!BethesdaArchive::open(writeArchive(QStringLiteral("unknown.bsa"), "NOPE and more"), &error));
+    QVERIFY(!error.isEmpty());
+
+    auto unsupported = makeBsa(104, BsaIncludeDirectoryNames | BsaIncludeFileNames, {});
+    unsupported[4] = static_cast<char>(99);
+    error.clear();
+    QVERIFY(!BethesdaArchive::open(writeArchive(QStringLiteral("unsupported.bsa"), unsupported), &error));
+    QVERIFY(!error.isEmpty());
+
+    const auto general = makeGeneralBa2({{.path = "meshes\\a.nif", .data = "data", .compressed = false}});
+    error.clear();
+    QVERIFY(!BethesdaArchive::open(writeArchive(QStringLiteral("truncated.ba2"), general.left(30)), &error));
+    QVERIFY(!error.isEmpty());
+
+    error.clear();
+    QVERIFY(!BethesdaArchive::open(m_Directory.filePath(QStringLiteral("missing.bsa")), &error));
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(BethesdaArchiveTest)
+#include "BethesdaArchiveTest.moc"